@@ -33,6 +33,7 @@
 #include "gf-monitor-manager-xrandr-private.h"
 #include "gf-output-private.h"
 #include "gf-output-xrandr-private.h"
+#include "gf-xrandr-reader-private.h"
 
 struct _GfGpuXrandr
 {
@@ -122,6 +123,7 @@ gf_gpu_xrandr_read_current (GfGpu   *gpu,
   GList *outputs;
   GList *modes;
   GList *crtcs;
+  GPtrArray *xrandr_outputs;
   guint i, j;
   GList *l;
   RROutput primary_output;
@@ -209,33 +211,30 @@ gf_gpu_xrandr_read_current (GfGpu   *gpu,
 
   primary_output = XRRGetOutputPrimary (xdisplay, DefaultRootWindow (xdisplay));
 
-  for (i = 0; i < (guint) resources->noutput; i++)
+  xrandr_outputs = gf_xrandr_reader_read_outputs (xdisplay,
+                                                  resources,
+                                                  gf_monitor_manager_xrandr_has_randr15 (monitor_manager_xrandr));
+
+  for (i = 0; i < xrandr_outputs->len; i++)
     {
-      RROutput output_id;
-      XRROutputInfo *xrandr_output;
+      GfXrandrOutput *xrandr_output;
+      GfOutputXrandr *output_xrandr;
 
-      output_id = resources->outputs[i];
-      xrandr_output = XRRGetOutputInfo (xdisplay, resources, output_id);
+      xrandr_output = g_ptr_array_index (xrandr_outputs, i);
 
-      if (!xrandr_output)
+      if (xrandr_output->info->connection == XCB_RANDR_CONNECTION_DISCONNECTED)
         continue;
 
-      if (xrandr_output->connection != RR_Disconnected)
-        {
-          GfOutputXrandr *output_xrandr;
-
-          output_xrandr = gf_output_xrandr_new (gpu_xrandr,
-                                                xrandr_output,
-                                                output_id,
-                                                primary_output);
+      output_xrandr = gf_output_xrandr_new (gpu_xrandr,
+                                            xrandr_output,
+                                            primary_output);
 
-          if (output_xrandr)
-            outputs = g_list_prepend (outputs, output_xrandr);
-        }
-
-      XRRFreeOutputInfo (xrandr_output);
+      if (output_xrandr)
+        outputs = g_list_prepend (outputs, output_xrandr);
     }
 
+  g_ptr_array_unref (xrandr_outputs);
+
   /* Sort the outputs for easier handling in GfMonitorConfig */
   outputs = g_list_sort (outputs, compare_outputs);
 
@@ -1190,7 +1190,6 @@ assign_logical_monitor_crtcs (GfMonitorManager        *manager,
 GfMonitorsConfigKey *
 gf_create_monitors_config_key_for_current_state (GfMonitorManager *monitor_manager)
 {
-  GfMonitorsConfigKey *config_key;
   GfMonitorSpec *laptop_monitor_spec;
   GList *l;
   GList *monitor_specs;
@@ -1225,11 +1224,8 @@ gf_create_monitors_config_key_for_current_state (GfMonitorManager *monitor_manag
 
   monitor_specs = g_list_sort (monitor_specs, (GCompareFunc) gf_monitor_spec_compare);
 
-  config_key = g_new0 (GfMonitorsConfigKey, 1);
-  config_key->monitor_specs = monitor_specs;
-  config_key->layout_mode = gf_monitor_manager_get_default_layout_mode (monitor_manager);
-
-  return config_key;
+  return gf_monitors_config_key_new (monitor_specs,
+                                     gf_monitor_manager_get_default_layout_mode (monitor_manager));
 }
 
 static void
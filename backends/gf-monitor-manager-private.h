@@ -75,6 +75,18 @@ struct _GfMonitorManager
   GfMonitorSwitchConfigType    current_switch_config;
 };
 
+/* Emitted with "monitor-changes", compared against the previous
+ * "monitors-changed" emission by monitor spec. It lives on the stack of
+ * the emission and is only valid during it, handlers have to copy what
+ * they want to keep.
+ */
+struct _GfMonitorsChanges
+{
+  GPtrArray *added;   /* GfMonitor */
+  GPtrArray *removed; /* GfMonitorSpec */
+  GPtrArray *changed; /* GfMonitor */
+};
+
 typedef struct
 {
   GObjectClass parent_class;
@@ -44,12 +44,7 @@
 #include "gf-monitor-private.h"
 #include "gf-monitor-tiled-private.h"
 #include "gf-output-xrandr-private.h"
-
-/* Look for DPI_FALLBACK in:
- * http://git.gnome.org/browse/gnome-settings-daemon/tree/plugins/xsettings/gsd-xsettings-manager.c
- * for the reasoning
- */
-#define DPI_FALLBACK 96.0
+#include "gf-xrandr-plan-private.h"
 
 struct _GfMonitorManagerXrandr
 {
@@ -296,6 +291,89 @@ gf_monitor_transform_to_xrandr (GfMonitorTransform transform)
   return rotation;
 }
 
+static void
+disable_crtc (GfMonitorManagerXrandr *xrandr,
+              GfCrtc                 *crtc,
+              gboolean                save_timestamp)
+{
+  xrandr_set_crtc_config (xrandr,
+                          crtc,
+                          save_timestamp,
+                          (xcb_randr_crtc_t) gf_crtc_get_id (crtc),
+                          XCB_CURRENT_TIME,
+                          0, 0, XCB_NONE,
+                          XCB_RANDR_ROTATION_ROTATE_0,
+                          NULL, 0);
+
+  gf_crtc_unset_config (crtc);
+}
+
+static void
+configure_crtc (GfMonitorManagerXrandr *xrandr,
+                GfCrtcAssignment       *crtc_assignment,
+                gboolean                save_timestamp)
+{
+  GfCrtc *crtc;
+  GfCrtcMode *crtc_mode;
+  xcb_randr_output_t *output_ids;
+  guint i, n_output_ids;
+  xcb_randr_rotation_t rotation;
+  xcb_randr_mode_t mode;
+
+  crtc = crtc_assignment->crtc;
+  crtc_mode = crtc_assignment->mode;
+
+  n_output_ids = crtc_assignment->outputs->len;
+  output_ids = g_new0 (xcb_randr_output_t, n_output_ids);
+
+  for (i = 0; i < n_output_ids; i++)
+    {
+      GfOutput *output;
+
+      output = ((GfOutput**) crtc_assignment->outputs->pdata)[i];
+      output_ids[i] = gf_output_get_id (output);
+    }
+
+  rotation = gf_monitor_transform_to_xrandr (crtc_assignment->transform);
+  mode = gf_crtc_mode_get_id (crtc_mode);
+
+  if (!xrandr_set_crtc_config (xrandr,
+                               crtc,
+                               save_timestamp,
+                               (xcb_randr_crtc_t) gf_crtc_get_id (crtc),
+                               XCB_CURRENT_TIME,
+                               crtc_assignment->layout.x,
+                               crtc_assignment->layout.y,
+                               mode,
+                               rotation,
+                               output_ids, n_output_ids))
+    {
+      const GfCrtcModeInfo *crtc_mode_info;
+
+      crtc_mode_info = gf_crtc_mode_get_info (crtc_mode);
+
+      g_warning ("Configuring CRTC %d with mode %d (%d x %d @ %f) at position %d, %d and transform %u failed\n",
+                 (unsigned) gf_crtc_get_id (crtc),
+                 (unsigned) mode,
+                 crtc_mode_info->width,
+                 crtc_mode_info->height,
+                 (double) crtc_mode_info->refresh_rate,
+                 crtc_assignment->layout.x,
+                 crtc_assignment->layout.y,
+                 crtc_assignment->transform);
+
+      g_free (output_ids);
+      return;
+    }
+
+  gf_crtc_set_config (crtc,
+                      &crtc_assignment->layout,
+                      crtc_mode,
+                      crtc_assignment->transform);
+
+  g_free (output_ids);
+}
+
 static void
 apply_crtc_assignments (GfMonitorManager    *manager,
                         gboolean             save_timestamp,
@@ -306,175 +384,75 @@ apply_crtc_assignments (GfMonitorManager    *manager,
 {
   GfMonitorManagerXrandr *xrandr;
   GfGpu *gpu;
+  GArray *ops;
   GList *to_configure_outputs;
-  GList *to_disable_crtcs;
-  gint width, height, width_mm, height_mm;
-  guint i;
+  guint i, j;
   GList *l;
 
   xrandr = GF_MONITOR_MANAGER_XRANDR (manager);
   gpu = get_gpu (xrandr);
 
-  to_configure_outputs = g_list_copy (gf_gpu_get_outputs (gpu));
-  to_disable_crtcs = g_list_copy (gf_gpu_get_crtcs (gpu));
+  ops = gf_xrandr_plan_crtc_assignments (gpu,
+                                         manager->screen_width,
+                                         manager->screen_height,
+                                         crtcs,
+                                         n_crtcs);
 
   XGrabServer (xrandr->xdisplay);
 
-  /* First compute the new size of the screen (framebuffer) */
-  width = 0; height = 0;
-  for (i = 0; i < n_crtcs; i++)
+  for (i = 0; i < ops->len; i++)
     {
-      GfCrtcAssignment *crtc_assignment = crtcs[i];
-      GfCrtc *crtc = crtc_assignment->crtc;
+      GfXrandrOp *op;
 
-      if (crtc_assignment->mode == NULL)
-        continue;
-
-      to_disable_crtcs = g_list_remove (to_disable_crtcs, crtc);
-
-      width = MAX (width, crtc_assignment->layout.x + crtc_assignment->layout.width);
-      height = MAX (height, crtc_assignment->layout.y + crtc_assignment->layout.height);
-    }
+      op = &g_array_index (ops, GfXrandrOp, i);
 
-  /* Second disable all newly disabled CRTCs, or CRTCs that in the previous
-   * configuration would be outside the new framebuffer (otherwise X complains
-   * loudly when resizing)
-   * CRTC will be enabled again after resizing the FB
-   */
-  for (i = 0; i < n_crtcs; i++)
-    {
-      GfCrtcAssignment *crtc_assignment = crtcs[i];
-      GfCrtc *crtc = crtc_assignment->crtc;
-      const GfCrtcConfig *crtc_config;
-      int x2, y2;
+      switch (op->type)
+        {
+          case GF_XRANDR_OP_DISABLE_CRTC:
+            disable_crtc (xrandr, op->crtc, save_timestamp);
+            break;
 
-      crtc_config = gf_crtc_get_config (crtc);
-      if (crtc_config == NULL)
-        continue;
+          case GF_XRANDR_OP_SET_SCREEN_SIZE:
+            XRRSetScreenSize (xrandr->xdisplay, xrandr->xroot,
+                              op->width, op->height,
+                              op->width_mm, op->height_mm);
+            break;
 
-      x2 = crtc_config->layout.x + crtc_config->layout.width;
-      y2 = crtc_config->layout.y + crtc_config->layout.height;
+          case GF_XRANDR_OP_SET_CRTC_CONFIG:
+            configure_crtc (xrandr, op->crtc_assignment, save_timestamp);
+            break;
 
-      if (crtc_assignment->mode == NULL || x2 > width || y2 > height)
-        {
-          xrandr_set_crtc_config (xrandr,
-                                  crtc,
-                                  save_timestamp,
-                                  (xcb_randr_crtc_t) gf_crtc_get_id (crtc),
-                                  XCB_CURRENT_TIME,
-                                  0, 0, XCB_NONE,
-                                  XCB_RANDR_ROTATION_ROTATE_0,
-                                  NULL, 0);
-
-          gf_crtc_unset_config (crtc);
+          default:
+            g_assert_not_reached ();
+            break;
         }
     }
 
-  for (l = to_disable_crtcs; l; l = l->next)
-    {
-      GfCrtc *crtc = l->data;
-
-      if (!gf_crtc_get_config (crtc))
-        continue;
-
-      xrandr_set_crtc_config (xrandr,
-                              crtc,
-                              save_timestamp,
-                              (xcb_randr_crtc_t) gf_crtc_get_id (crtc),
-                              XCB_CURRENT_TIME,
-                              0, 0, XCB_NONE,
-                              XCB_RANDR_ROTATION_ROTATE_0,
-                              NULL, 0);
-
-      gf_crtc_unset_config (crtc);
-    }
+  g_array_unref (ops);
 
   if (n_crtcs == 0)
     goto out;
 
-  g_assert (width > 0 && height > 0);
-  /* The 'physical size' of an X screen is meaningless if that screen
-   * can consist of many monitors. So just pick a size that make the
-   * dpi 96.
-   *
-   * Firefox and Evince apparently believe what X tells them.
-   */
-  width_mm = (width / DPI_FALLBACK) * 25.4 + 0.5;
-  height_mm = (height / DPI_FALLBACK) * 25.4 + 0.5;
-  XRRSetScreenSize (xrandr->xdisplay, xrandr->xroot,
-                    width, height, width_mm, height_mm);
+  to_configure_outputs = g_list_copy (gf_gpu_get_outputs (gpu));
 
   for (i = 0; i < n_crtcs; i++)
     {
       GfCrtcAssignment *crtc_assignment = crtcs[i];
-      GfCrtc *crtc = crtc_assignment->crtc;
 
-      if (crtc_assignment->mode != NULL)
+      if (crtc_assignment->mode == NULL)
+        continue;
+
+      for (j = 0; j < crtc_assignment->outputs->len; j++)
         {
-          GfCrtcMode *crtc_mode;
-          xcb_randr_output_t *output_ids;
-          guint j, n_output_ids;
-          xcb_randr_rotation_t rotation;
-          xcb_randr_mode_t mode;
-
-          crtc_mode = crtc_assignment->mode;
-
-          n_output_ids = crtc_assignment->outputs->len;
-          output_ids = g_new0 (xcb_randr_output_t, n_output_ids);
-
-          for (j = 0; j < n_output_ids; j++)
-            {
-              GfOutput *output;
-              GfOutputAssignment *output_assignment;
-
-              output = ((GfOutput**) crtc_assignment->outputs->pdata)[j];
-
-              to_configure_outputs = g_list_remove (to_configure_outputs, output);
-
-              output_assignment = gf_find_output_assignment (outputs, n_outputs, output);
-              gf_output_assign_crtc (output, crtc, output_assignment);
-
-              output_ids[j] = gf_output_get_id (output);
-            }
-
-          rotation = gf_monitor_transform_to_xrandr (crtc_assignment->transform);
-          mode = gf_crtc_mode_get_id (crtc_mode);
-
-          if (!xrandr_set_crtc_config (xrandr,
-                                       crtc,
-                                       save_timestamp,
-                                       (xcb_randr_crtc_t) gf_crtc_get_id (crtc),
-                                       XCB_CURRENT_TIME,
-                                       crtc_assignment->layout.x,
-                                       crtc_assignment->layout.y,
-                                       mode,
-                                       rotation,
-                                       output_ids, n_output_ids))
-            {
-              const GfCrtcModeInfo *crtc_mode_info;
-
-              crtc_mode_info = gf_crtc_mode_get_info (crtc_mode);
-
-              g_warning ("Configuring CRTC %d with mode %d (%d x %d @ %f) at position %d, %d and transform %u failed\n",
-                         (unsigned) gf_crtc_get_id (crtc),
-                         (unsigned) mode,
-                         crtc_mode_info->width,
-                         crtc_mode_info->height,
-                         (double) crtc_mode_info->refresh_rate,
-                         crtc_assignment->layout.x,
-                         crtc_assignment->layout.y,
-                         crtc_assignment->transform);
-
-              g_free (output_ids);
-              continue;
-            }
-
-          gf_crtc_set_config (crtc,
-                              &crtc_assignment->layout,
-                              crtc_mode,
-                              crtc_assignment->transform);
-
-          g_free (output_ids);
+          GfOutput *output;
+          GfOutputAssignment *output_assignment;
+
+          output = ((GfOutput**) crtc_assignment->outputs->pdata)[j];
+
+          to_configure_outputs = g_list_remove (to_configure_outputs, output);
+
+          output_assignment = gf_find_output_assignment (outputs, n_outputs, output);
+          gf_output_assign_crtc (output, crtc_assignment->crtc, output_assignment);
         }
     }
 
@@ -493,12 +471,11 @@ apply_crtc_assignments (GfMonitorManager    *manager,
       gf_output_unassign_crtc (output);
     }
 
+  g_list_free (to_configure_outputs);
+
 out:
   XUngrabServer (xrandr->xdisplay);
   XFlush (xrandr->xdisplay);
-
-  g_clear_pointer (&to_configure_outputs, g_list_free);
-  g_clear_pointer (&to_disable_crtcs, g_list_free);
 }
 
 static GQuark
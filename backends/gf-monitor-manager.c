@@ -28,6 +28,7 @@
 
 #include "config.h"
 
+#include <float.h>
 #include <math.h>
 #include <string.h>
 
@@ -59,8 +60,23 @@ typedef struct
   gboolean     initial_orient_change_done;
 
   uint32_t     backlight_serial;
+
+  /* GfMonitorSpec -> MonitorState at the last notification */
+  GHashTable  *monitor_states;
 } GfMonitorManagerPrivate;
 
+typedef struct
+{
+  gboolean           is_active;
+  gboolean           is_primary;
+  int                width;
+  int                height;
+  float              refresh_rate;
+  GfRectangle        rect;
+  float              scale;
+  GfMonitorTransform transform;
+} MonitorState;
+
 typedef gboolean (* MonitorMatchFunc) (GfMonitor *monitor);
 
 enum
@@ -78,6 +94,7 @@ static GParamSpec *manager_properties[LAST_PROP] = { NULL };
 
 enum
 {
+  MONITOR_CHANGES,
   MONITORS_CHANGED,
   POWER_SAVE_MODE_CHANGED,
   CONFIRM_DISPLAY_CHANGE,
@@ -295,10 +312,110 @@ update_backlight (GfMonitorManager *self,
   gf_dbus_display_config_set_backlight (self->display_config, backlight);
 }
 
+static void
+get_monitor_state (GfMonitor    *monitor,
+                   MonitorState *state)
+{
+  GfMonitorMode *mode;
+  GfLogicalMonitor *logical_monitor;
+
+  *state = (MonitorState) { 0 };
+
+  state->is_active = gf_monitor_is_active (monitor);
+  state->is_primary = gf_monitor_is_primary (monitor);
+
+  mode = gf_monitor_get_current_mode (monitor);
+  if (mode != NULL)
+    {
+      gf_monitor_mode_get_resolution (mode, &state->width, &state->height);
+      state->refresh_rate = gf_monitor_mode_get_refresh_rate (mode);
+    }
+
+  logical_monitor = gf_monitor_get_logical_monitor (monitor);
+  if (logical_monitor != NULL)
+    {
+      state->rect = logical_monitor->rect;
+      state->scale = logical_monitor->scale;
+      state->transform = logical_monitor->transform;
+    }
+}
+
+static gboolean
+monitor_state_equal (const MonitorState *state,
+                     const MonitorState *other_state)
+{
+  return state->is_active == other_state->is_active &&
+         state->is_primary == other_state->is_primary &&
+         state->width == other_state->width &&
+         state->height == other_state->height &&
+         G_APPROX_VALUE (state->refresh_rate, other_state->refresh_rate, FLT_EPSILON) &&
+         gf_rectangle_equal (&state->rect, &other_state->rect) &&
+         G_APPROX_VALUE (state->scale, other_state->scale, FLT_EPSILON) &&
+         state->transform == other_state->transform;
+}
+
+static GHashTable *
+monitor_states_new (void)
+{
+  return g_hash_table_new_full (gf_monitor_spec_hash,
+                                (GEqualFunc) gf_monitor_spec_equals,
+                                (GDestroyNotify) gf_monitor_spec_free,
+                                g_free);
+}
+
+static void
+update_monitor_states (GfMonitorManager  *manager,
+                       GfMonitorsChanges *changes)
+{
+  GfMonitorManagerPrivate *priv;
+  GHashTable *monitor_states;
+  GHashTableIter iter;
+  gpointer key;
+  GList *l;
+
+  priv = gf_monitor_manager_get_instance_private (manager);
+
+  monitor_states = monitor_states_new ();
+
+  for (l = manager->monitors; l; l = l->next)
+    {
+      GfMonitor *monitor;
+      GfMonitorSpec *spec;
+      MonitorState *state;
+      MonitorState *old_state;
+
+      monitor = l->data;
+      spec = gf_monitor_get_spec (monitor);
+
+      state = g_new (MonitorState, 1);
+      get_monitor_state (monitor, state);
+
+      old_state = g_hash_table_lookup (priv->monitor_states, spec);
+
+      if (old_state == NULL)
+        g_ptr_array_add (changes->added, monitor);
+      else if (!monitor_state_equal (state, old_state))
+        g_ptr_array_add (changes->changed, monitor);
+
+      g_hash_table_insert (monitor_states, gf_monitor_spec_clone (spec), state);
+    }
+
+  g_hash_table_iter_init (&iter, priv->monitor_states);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      if (!g_hash_table_contains (monitor_states, key))
+        g_ptr_array_add (changes->removed, gf_monitor_spec_clone (key));
+    }
+
+  g_hash_table_destroy (priv->monitor_states);
+  priv->monitor_states = monitor_states;
+}
+
 static void
 gf_monitor_manager_notify_monitors_changed (GfMonitorManager *manager)
 {
   GfMonitorManagerPrivate *priv;
+  GfMonitorsChanges changes;
 
   priv = gf_monitor_manager_get_instance_private (manager);
 
@@ -307,8 +424,19 @@ gf_monitor_manager_notify_monitors_changed (GfMonitorManager *manager)
   update_has_external_monitor (manager);
   update_backlight (manager, TRUE);
 
+  changes.added = g_ptr_array_new ();
+  changes.removed = g_ptr_array_new_with_free_func ((GDestroyNotify) gf_monitor_spec_free);
+  changes.changed = g_ptr_array_new ();
+
+  update_monitor_states (manager, &changes);
+
+  g_signal_emit (manager, manager_signals[MONITOR_CHANGES], 0, &changes);
   g_signal_emit (manager, manager_signals[MONITORS_CHANGED], 0);
 
+  g_ptr_array_unref (changes.added);
+  g_ptr_array_unref (changes.removed);
+  g_ptr_array_unref (changes.changed);
+
   gf_dbus_display_config_emit_monitors_changed (manager->display_config);
 }
 
@@ -2634,10 +2762,13 @@ static void
 gf_monitor_manager_finalize (GObject *object)
 {
   GfMonitorManager *manager;
+  GfMonitorManagerPrivate *priv;
 
   manager = GF_MONITOR_MANAGER (object);
+  priv = gf_monitor_manager_get_instance_private (manager);
 
   g_list_free_full (manager->logical_monitors, g_object_unref);
+  g_clear_pointer (&priv->monitor_states, g_hash_table_destroy);
 
   G_OBJECT_CLASS (gf_monitor_manager_parent_class)->finalize (object);
 }
@@ -2725,6 +2856,15 @@ gf_monitor_manager_install_properties (GObjectClass *object_class)
 static void
 gf_monitor_manager_install_signals (GObjectClass *object_class)
 {
+  /* The GfMonitorsChanges argument is only valid during the emission */
+  manager_signals[MONITOR_CHANGES] =
+    g_signal_new ("monitor-changes",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, G_TYPE_POINTER);
+
   manager_signals[MONITORS_CHANGED] =
     g_signal_new ("monitors-changed",
                   G_TYPE_FROM_CLASS (object_class),
@@ -2772,6 +2912,11 @@ gf_monitor_manager_class_init (GfMonitorManagerClass *manager_class)
 static void
 gf_monitor_manager_init (GfMonitorManager *manager)
 {
+  GfMonitorManagerPrivate *priv;
+
+  priv = gf_monitor_manager_get_instance_private (manager);
+
+  priv->monitor_states = monitor_states_new ();
 }
 
 GfBackend *
@@ -2914,6 +3059,26 @@ gf_monitor_manager_read_current_state (GfMonitorManager *manager)
   return GF_MONITOR_MANAGER_GET_CLASS (manager)->read_current_state (manager);
 }
 
+gboolean
+gf_monitors_changes_is_empty (const GfMonitorsChanges *changes)
+{
+  return changes->added->len == 0 &&
+         changes->removed->len == 0 &&
+         changes->changed->len == 0;
+}
+
+guint
+gf_monitors_changes_get_n_added (const GfMonitorsChanges *changes)
+{
+  return changes->added->len;
+}
+
+guint
+gf_monitors_changes_get_n_removed (const GfMonitorsChanges *changes)
+{
+  return changes->removed->len;
+}
+
 void
 gf_monitor_manager_reconfigure (GfMonitorManager *self)
 {
@@ -3432,3 +3597,12 @@ gf_monitor_manager_confirm_configuration (GfMonitorManager *manager,
   cancel_persistent_confirmation (manager);
   confirm_configuration (manager, ok);
 }
+
+void
+gf_monitor_manager_get_screen_size (GfMonitorManager *manager,
+                                    int              *width,
+                                    int              *height)
+{
+  *width = manager->screen_width;
+  *height = manager->screen_height;
+}
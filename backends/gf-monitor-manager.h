@@ -36,6 +36,7 @@ typedef enum
 } GfMonitorSwitchConfigType;
 
 typedef struct _GfMonitorManager GfMonitorManager;
+typedef struct _GfMonitorsChanges GfMonitorsChanges;
 
 gint                      gf_monitor_manager_get_monitor_for_connector         (GfMonitorManager          *manager,
                                                                                 const gchar               *connector);
@@ -56,6 +57,16 @@ gboolean                  gf_monitor_manager_get_panel_orientation_managed     (
 void                      gf_monitor_manager_confirm_configuration             (GfMonitorManager          *manager,
                                                                                 gboolean                   ok);
 
+void                      gf_monitor_manager_get_screen_size                   (GfMonitorManager          *manager,
+                                                                                int                       *width,
+                                                                                int                       *height);
+
+gboolean                  gf_monitors_changes_is_empty                         (const GfMonitorsChanges   *changes);
+
+guint                     gf_monitors_changes_get_n_added                      (const GfMonitorsChanges   *changes);
+
+guint                     gf_monitors_changes_get_n_removed                    (const GfMonitorsChanges   *changes);
+
 G_END_DECLS
 
 #endif
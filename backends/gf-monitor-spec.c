@@ -26,6 +26,8 @@
 
 #include "gf-monitor-spec-private.h"
 
+static GHashTable *interned_specs = NULL;
+
 GfMonitorSpec *
 gf_monitor_spec_clone (GfMonitorSpec *spec)
 {
@@ -41,6 +43,36 @@ gf_monitor_spec_clone (GfMonitorSpec *spec)
   return new_spec;
 }
 
+/*
+ * Returns the canonical copy of @spec. Like g_intern_string(), it is
+ * never freed, and equal specs always intern to the same pointer.
+ *
+ * Keeping them for the lifetime of the process is intended: there is
+ * one entry per physical monitor ever seen in monitors.xml or on a
+ * connector, not per stored layout, and reloading the config store
+ * interns the same specs again instead of adding new ones.
+ */
+GfMonitorSpec *
+gf_monitor_spec_intern (GfMonitorSpec *spec)
+{
+  GfMonitorSpec *interned_spec;
+
+  if (interned_specs == NULL)
+    {
+      interned_specs = g_hash_table_new (gf_monitor_spec_hash,
+                                         (GEqualFunc) gf_monitor_spec_equals);
+    }
+
+  interned_spec = g_hash_table_lookup (interned_specs, spec);
+  if (interned_spec != NULL)
+    return interned_spec;
+
+  interned_spec = gf_monitor_spec_clone (spec);
+  g_hash_table_add (interned_specs, interned_spec);
+
+  return interned_spec;
+}
+
 guint
 gf_monitor_spec_hash (gconstpointer key)
 {
@@ -30,6 +30,11 @@ typedef struct
 {
   GList *monitor_specs;
   GfLogicalMonitorLayoutMode layout_mode;
+
+  /* Interned monitor_specs, so keys compare by pointer */
+  GfMonitorSpec **interned_specs;
+  guint n_specs;
+  guint hash;
 } GfMonitorsConfigKey;
 
 typedef enum
@@ -78,6 +83,9 @@ GfMonitorSwitchConfigType  gf_monitors_config_get_switch_config (GfMonitorsConfi
 void                       gf_monitors_config_set_switch_config (GfMonitorsConfig            *config,
                                                                  GfMonitorSwitchConfigType    switch_config);
 
+GfMonitorsConfigKey       *gf_monitors_config_key_new           (GList                       *monitor_specs,
+                                                                 GfLogicalMonitorLayoutMode   layout_mode);
+
 guint                      gf_monitors_config_key_hash          (gconstpointer                data);
 
 gboolean                   gf_monitors_config_key_equal         (gconstpointer                data_a,
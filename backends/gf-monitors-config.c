@@ -41,11 +41,10 @@ gf_monitors_config_is_monitor_enabled (GfMonitorsConfig *config,
 }
 
 static GfMonitorsConfigKey *
-gf_monitors_config_key_new (GList                      *logical_monitor_configs,
+create_monitors_config_key (GList                      *logical_monitor_configs,
                             GList                      *disabled_monitor_specs,
                             GfLogicalMonitorLayoutMode  layout_mode)
 {
-  GfMonitorsConfigKey *config_key;
   GList *monitor_specs;
   GList *l;
 
@@ -75,11 +74,7 @@ gf_monitors_config_key_new (GList                      *logical_monitor_configs,
 
   monitor_specs = g_list_sort (monitor_specs, (GCompareFunc) gf_monitor_spec_compare);
 
-  config_key = g_new0 (GfMonitorsConfigKey, 1);
-  config_key->monitor_specs = monitor_specs;
-  config_key->layout_mode = layout_mode;
-
-  return config_key;
+  return gf_monitors_config_key_new (monitor_specs, layout_mode);
 }
 
 static void
@@ -127,7 +122,7 @@ gf_monitors_config_new_full (GList                      *logical_monitor_configs
   config->logical_monitor_configs = logical_monitor_configs;
   config->disabled_monitor_specs = disabled_monitor_specs;
   config->layout_mode = layout_mode;
-  config->key = gf_monitors_config_key_new (logical_monitor_configs,
+  config->key = create_monitors_config_key (logical_monitor_configs,
                                             disabled_monitor_specs,
                                             layout_mode);
   config->flags = flags;
@@ -193,27 +188,50 @@ gf_monitors_config_set_switch_config (GfMonitorsConfig          *config,
   config->switch_config = switch_config;
 }
 
-guint
-gf_monitors_config_key_hash (gconstpointer data)
+/*
+ * Takes ownership of @monitor_specs, which must be sorted with
+ * gf_monitor_spec_compare().
+ */
+GfMonitorsConfigKey *
+gf_monitors_config_key_new (GList                      *monitor_specs,
+                            GfLogicalMonitorLayoutMode  layout_mode)
 {
-  const GfMonitorsConfigKey *config_key;
-  glong hash;
+  GfMonitorsConfigKey *config_key;
+  guint hash;
+  guint i;
   GList *l;
 
-  config_key = data;
-  hash = config_key->layout_mode;
+  config_key = g_new0 (GfMonitorsConfigKey, 1);
+  config_key->monitor_specs = monitor_specs;
+  config_key->layout_mode = layout_mode;
 
-  for (l = config_key->monitor_specs; l; l = l->next)
+  config_key->n_specs = g_list_length (monitor_specs);
+  config_key->interned_specs = g_new (GfMonitorSpec *, config_key->n_specs);
+
+  hash = layout_mode;
+  for (l = monitor_specs, i = 0; l; l = l->next, i++)
     {
-      GfMonitorSpec *monitor_spec = l->data;
+      GfMonitorSpec *interned_spec;
+
+      interned_spec = gf_monitor_spec_intern (l->data);
+      config_key->interned_specs[i] = interned_spec;
 
-      hash ^= (g_str_hash (monitor_spec->connector) ^
-               g_str_hash (monitor_spec->vendor) ^
-               g_str_hash (monitor_spec->product) ^
-               g_str_hash (monitor_spec->serial));
+      hash = hash * 31 + g_direct_hash (interned_spec);
     }
 
-  return hash;
+  config_key->hash = hash;
+
+  return config_key;
+}
+
+guint
+gf_monitors_config_key_hash (gconstpointer data)
+{
+  const GfMonitorsConfigKey *config_key;
+
+  config_key = data;
+
+  return config_key->hash;
 }
 
 gboolean
@@ -222,28 +240,22 @@ gf_monitors_config_key_equal (gconstpointer data_a,
 {
   const GfMonitorsConfigKey *config_key_a;
   const GfMonitorsConfigKey *config_key_b;
-  GList *l_a, *l_b;
+  guint i;
 
   config_key_a = data_a;
   config_key_b = data_b;
 
-  if (config_key_a->layout_mode != config_key_b->layout_mode)
+  if (config_key_a->hash != config_key_b->hash ||
+      config_key_a->layout_mode != config_key_b->layout_mode ||
+      config_key_a->n_specs != config_key_b->n_specs)
     return FALSE;
 
-  for (l_a = config_key_a->monitor_specs, l_b = config_key_b->monitor_specs;
-       l_a && l_b;
-       l_a = l_a->next, l_b = l_b->next)
+  for (i = 0; i < config_key_a->n_specs; i++)
     {
-      GfMonitorSpec *monitor_spec_a = l_a->data;
-      GfMonitorSpec *monitor_spec_b = l_b->data;
-
-      if (!gf_monitor_spec_equals (monitor_spec_a, monitor_spec_b))
+      if (config_key_a->interned_specs[i] != config_key_b->interned_specs[i])
         return FALSE;
     }
 
-  if (l_a || l_b)
-    return FALSE;
-
   return TRUE;
 }
 
@@ -251,6 +263,7 @@ void
 gf_monitors_config_key_free (GfMonitorsConfigKey *config_key)
 {
   g_list_free_full (config_key->monitor_specs, (GDestroyNotify) gf_monitor_spec_free);
+  g_free (config_key->interned_specs);
   g_free (config_key);
 }
 
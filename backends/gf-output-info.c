@@ -28,6 +28,18 @@
 
 #include "gf-edid-private.h"
 
+/* Parsed EDIDs, keyed by the raw EDID blob */
+#define EDID_CACHE_SIZE 16
+
+typedef struct
+{
+  char *vendor;
+  char *product;
+  char *serial;
+} EdidCacheEntry;
+
+static GHashTable *edid_cache = NULL;
+
 G_DEFINE_BOXED_TYPE (GfOutputInfo,
                      gf_output_info,
                      gf_output_info_ref,
@@ -68,47 +80,100 @@ gf_output_info_unref (GfOutputInfo *self)
     }
 }
 
-void
-gf_output_info_parse_edid (GfOutputInfo *output_info,
-                           GBytes       *edid)
+static void
+edid_cache_entry_free (EdidCacheEntry *entry)
 {
+  g_free (entry->vendor);
+  g_free (entry->product);
+  g_free (entry->serial);
+  g_free (entry);
+}
+
+static EdidCacheEntry *
+edid_cache_entry_new (GBytes *edid)
+{
+  EdidCacheEntry *entry;
   GfEdidInfo *parsed_edid;
   gsize len;
 
-  if (!edid)
-    {
-      output_info->vendor = g_strdup ("unknown");
-      output_info->product = g_strdup ("unknown");
-      output_info->serial = g_strdup ("unknown");
-      return;
-    }
+  entry = g_new0 (EdidCacheEntry, 1);
 
   parsed_edid = gf_edid_info_new_parse (g_bytes_get_data (edid, &len));
   if (parsed_edid)
     {
-      output_info->vendor = g_strndup (parsed_edid->manufacturer_code, 4);
-      if (!g_utf8_validate (output_info->vendor, -1, NULL))
-        g_clear_pointer (&output_info->vendor, g_free);
+      entry->vendor = g_strndup (parsed_edid->manufacturer_code, 4);
+      if (!g_utf8_validate (entry->vendor, -1, NULL))
+        g_clear_pointer (&entry->vendor, g_free);
 
-      output_info->product = g_strndup (parsed_edid->dsc_product_name, 14);
-      if (!g_utf8_validate (output_info->product, -1, NULL) ||
-          output_info->product[0] == '\0')
+      entry->product = g_strndup (parsed_edid->dsc_product_name, 14);
+      if (!g_utf8_validate (entry->product, -1, NULL) ||
+          entry->product[0] == '\0')
         {
-          g_clear_pointer (&output_info->product, g_free);
-          output_info->product = g_strdup_printf ("0x%04x", (unsigned) parsed_edid->product_code);
+          g_clear_pointer (&entry->product, g_free);
+          entry->product = g_strdup_printf ("0x%04x", (unsigned) parsed_edid->product_code);
         }
 
-      output_info->serial = g_strndup (parsed_edid->dsc_serial_number, 14);
-      if (!g_utf8_validate (output_info->serial, -1, NULL) ||
-          output_info->serial[0] == '\0')
+      entry->serial = g_strndup (parsed_edid->dsc_serial_number, 14);
+      if (!g_utf8_validate (entry->serial, -1, NULL) ||
+          entry->serial[0] == '\0')
         {
-          g_clear_pointer (&output_info->serial, g_free);
-          output_info->serial = g_strdup_printf ("0x%08x", parsed_edid->serial_number);
+          g_clear_pointer (&entry->serial, g_free);
+          entry->serial = g_strdup_printf ("0x%08x", parsed_edid->serial_number);
         }
 
       g_free (parsed_edid);
     }
 
+  return entry;
+}
+
+static const EdidCacheEntry *
+edid_cache_lookup (GBytes *edid)
+{
+  EdidCacheEntry *entry;
+
+  if (edid_cache == NULL)
+    {
+      edid_cache = g_hash_table_new_full (g_bytes_hash,
+                                          g_bytes_equal,
+                                          (GDestroyNotify) g_bytes_unref,
+                                          (GDestroyNotify) edid_cache_entry_free);
+    }
+
+  entry = g_hash_table_lookup (edid_cache, edid);
+  if (entry != NULL)
+    return entry;
+
+  /* Connected monitors rarely change, starting over when full is enough */
+  if (g_hash_table_size (edid_cache) >= EDID_CACHE_SIZE)
+    g_hash_table_remove_all (edid_cache);
+
+  entry = edid_cache_entry_new (edid);
+  g_hash_table_insert (edid_cache, g_bytes_ref (edid), entry);
+
+  return entry;
+}
+
+void
+gf_output_info_parse_edid (GfOutputInfo *output_info,
+                           GBytes       *edid)
+{
+  const EdidCacheEntry *entry;
+
+  if (!edid)
+    {
+      output_info->vendor = g_strdup ("unknown");
+      output_info->product = g_strdup ("unknown");
+      output_info->serial = g_strdup ("unknown");
+      return;
+    }
+
+  entry = edid_cache_lookup (edid);
+
+  output_info->vendor = g_strdup (entry->vendor);
+  output_info->product = g_strdup (entry->product);
+  output_info->serial = g_strdup (entry->serial);
+
   if (!output_info->vendor)
     output_info->vendor = g_strdup ("unknown");
 
@@ -24,6 +24,7 @@
 
 #include "gf-gpu-xrandr-private.h"
 #include "gf-output-private.h"
+#include "gf-xrandr-reader-private.h"
 
 G_BEGIN_DECLS
 
@@ -31,10 +32,9 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GfOutputXrandr, gf_output_xrandr,
                       GF, OUTPUT_XRANDR, GfOutput)
 
-GfOutputXrandr *gf_output_xrandr_new             (GfGpuXrandr    *gpu_xrandr,
-                                                  XRROutputInfo  *xrandr_output,
-                                                  RROutput        output_id,
-                                                  RROutput        primary_output);
+GfOutputXrandr *gf_output_xrandr_new             (GfGpuXrandr          *gpu_xrandr,
+                                                  const GfXrandrOutput *xrandr_output,
+                                                  RROutput              primary_output);
 
 GBytes        *gf_output_xrandr_read_edid        (GfOutputXrandr *self);
 
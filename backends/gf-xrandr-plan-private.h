@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2013 Red Hat Inc.
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Adapted from mutter:
+ * - src/backends/x11/meta-monitor-manager-xrandr.c
+ */
+
+#ifndef GF_XRANDR_PLAN_PRIVATE_H
+#define GF_XRANDR_PLAN_PRIVATE_H
+
+#include "gf-crtc-private.h"
+#include "gf-gpu-private.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  GF_XRANDR_OP_DISABLE_CRTC,
+  GF_XRANDR_OP_SET_SCREEN_SIZE,
+  GF_XRANDR_OP_SET_CRTC_CONFIG
+} GfXrandrOpType;
+
+typedef struct
+{
+  GfXrandrOpType    type;
+
+  /* GF_XRANDR_OP_DISABLE_CRTC and GF_XRANDR_OP_SET_CRTC_CONFIG */
+  GfCrtc           *crtc;
+  GfCrtcAssignment *crtc_assignment;
+
+  /* GF_XRANDR_OP_SET_SCREEN_SIZE */
+  int               width;
+  int               height;
+  int               width_mm;
+  int               height_mm;
+} GfXrandrOp;
+
+GArray *gf_xrandr_plan_crtc_assignments (GfGpu             *gpu,
+                                         int                screen_width,
+                                         int                screen_height,
+                                         GfCrtcAssignment **crtcs,
+                                         guint              n_crtcs);
+
+G_END_DECLS
+
+#endif
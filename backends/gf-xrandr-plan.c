@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2013 Red Hat Inc.
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Adapted from mutter:
+ * - src/backends/x11/meta-monitor-manager-xrandr.c
+ */
+
+#include "config.h"
+#include "gf-xrandr-plan-private.h"
+
+#include "gf-output-private.h"
+
+/* Look for DPI_FALLBACK in:
+ * http://git.gnome.org/browse/gnome-settings-daemon/tree/plugins/xsettings/gsd-xsettings-manager.c
+ * for the reasoning
+ */
+#define DPI_FALLBACK 96.0
+
+static GfCrtcAssignment *
+find_enabled_crtc_assignment (GfCrtcAssignment **crtcs,
+                              guint              n_crtcs,
+                              GfCrtc            *crtc)
+{
+  guint i;
+
+  for (i = 0; i < n_crtcs; i++)
+    {
+      if (crtcs[i]->crtc == crtc && crtcs[i]->mode != NULL)
+        return crtcs[i];
+    }
+
+  return NULL;
+}
+
+static gboolean
+crtc_needs_config (GfGpu            *gpu,
+                   GfCrtc           *crtc,
+                   GfCrtcAssignment *crtc_assignment)
+{
+  const GfCrtcConfig *crtc_config;
+  guint n_assigned_outputs;
+  guint i;
+  GList *l;
+
+  crtc_config = gf_crtc_get_config (crtc);
+
+  if (crtc_config == NULL ||
+      crtc_config->mode != crtc_assignment->mode ||
+      crtc_config->layout.x != crtc_assignment->layout.x ||
+      crtc_config->layout.y != crtc_assignment->layout.y ||
+      crtc_config->transform != crtc_assignment->transform)
+    return TRUE;
+
+  for (i = 0; i < crtc_assignment->outputs->len; i++)
+    {
+      GfOutput *output;
+
+      output = g_ptr_array_index (crtc_assignment->outputs, i);
+
+      if (gf_output_get_assigned_crtc (output) != crtc)
+        return TRUE;
+    }
+
+  /* Also catch outputs that are removed from a cloned CRTC */
+  n_assigned_outputs = 0;
+  for (l = gf_gpu_get_outputs (gpu); l; l = l->next)
+    {
+      if (gf_output_get_assigned_crtc (l->data) == crtc)
+        n_assigned_outputs++;
+    }
+
+  return n_assigned_outputs != crtc_assignment->outputs->len;
+}
+
+static gboolean
+is_crtc_disabled_in_plan (GArray *ops,
+                          GfCrtc *crtc)
+{
+  guint i;
+
+  for (i = 0; i < ops->len; i++)
+    {
+      GfXrandrOp *op;
+
+      op = &g_array_index (ops, GfXrandrOp, i);
+
+      if (op->type == GF_XRANDR_OP_DISABLE_CRTC && op->crtc == crtc)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * Computes the XRandR requests needed to go from the current CRTC state
+ * to @crtcs without sending any of them. CRTCs that keep their mode,
+ * position, transform and outputs are left alone, and the screen is
+ * only resized when its size changes.
+ */
+GArray *
+gf_xrandr_plan_crtc_assignments (GfGpu             *gpu,
+                                 int                screen_width,
+                                 int                screen_height,
+                                 GfCrtcAssignment **crtcs,
+                                 guint              n_crtcs)
+{
+  GArray *ops;
+  int width;
+  int height;
+  guint i;
+  GList *l;
+
+  ops = g_array_new (FALSE, TRUE, sizeof (GfXrandrOp));
+
+  /* First compute the new size of the screen (framebuffer) */
+  width = 0; height = 0;
+  for (i = 0; i < n_crtcs; i++)
+    {
+      GfCrtcAssignment *crtc_assignment = crtcs[i];
+
+      if (crtc_assignment->mode == NULL)
+        continue;
+
+      width = MAX (width, crtc_assignment->layout.x + crtc_assignment->layout.width);
+      height = MAX (height, crtc_assignment->layout.y + crtc_assignment->layout.height);
+    }
+
+  /* Then disable CRTCs that are turned off, and changed CRTCs that in the
+   * current configuration would be outside the new framebuffer (otherwise
+   * X complains loudly when resizing)
+   */
+  for (l = gf_gpu_get_crtcs (gpu); l; l = l->next)
+    {
+      GfCrtc *crtc = l->data;
+      const GfCrtcConfig *crtc_config;
+      GfCrtcAssignment *crtc_assignment;
+      gboolean outside;
+
+      crtc_config = gf_crtc_get_config (crtc);
+      if (crtc_config == NULL)
+        continue;
+
+      crtc_assignment = find_enabled_crtc_assignment (crtcs, n_crtcs, crtc);
+
+      outside = crtc_config->layout.x + crtc_config->layout.width > width ||
+                crtc_config->layout.y + crtc_config->layout.height > height;
+
+      if (crtc_assignment == NULL ||
+          (outside && crtc_needs_config (gpu, crtc, crtc_assignment)))
+        {
+          GfXrandrOp op = { 0 };
+
+          op.type = GF_XRANDR_OP_DISABLE_CRTC;
+          op.crtc = crtc;
+
+          g_array_append_val (ops, op);
+        }
+    }
+
+  if (width == 0 || height == 0)
+    return ops;
+
+  if (width != screen_width || height != screen_height)
+    {
+      GfXrandrOp op = { 0 };
+
+      op.type = GF_XRANDR_OP_SET_SCREEN_SIZE;
+      op.width = width;
+      op.height = height;
+
+      /* The 'physical size' of an X screen is meaningless if that screen
+       * can consist of many monitors. So just pick a size that make the
+       * dpi 96.
+       *
+       * Firefox and Evince apparently believe what X tells them.
+       */
+      op.width_mm = (width / DPI_FALLBACK) * 25.4 + 0.5;
+      op.height_mm = (height / DPI_FALLBACK) * 25.4 + 0.5;
+
+      g_array_append_val (ops, op);
+    }
+
+  /* Finally set up CRTCs that were disabled above or that change */
+  for (i = 0; i < n_crtcs; i++)
+    {
+      GfCrtcAssignment *crtc_assignment = crtcs[i];
+      GfCrtc *crtc = crtc_assignment->crtc;
+      GfXrandrOp op = { 0 };
+
+      if (crtc_assignment->mode == NULL)
+        continue;
+
+      if (!is_crtc_disabled_in_plan (ops, crtc) &&
+          !crtc_needs_config (gpu, crtc, crtc_assignment))
+        continue;
+
+      op.type = GF_XRANDR_OP_SET_CRTC_CONFIG;
+      op.crtc = crtc;
+      op.crtc_assignment = crtc_assignment;
+
+      g_array_append_val (ops, op);
+    }
+
+  return ops;
+}
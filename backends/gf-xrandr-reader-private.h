@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2013-2017 Red Hat Inc.
+ * Copyright (C) 2019 Alberts Muktupāvels
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GF_XRANDR_READER_PRIVATE_H
+#define GF_XRANDR_READER_PRIVATE_H
+
+#include <glib.h>
+#include <X11/extensions/Xrandr.h>
+#include <xcb/randr.h>
+
+#include "gf-output-info-private.h"
+
+G_BEGIN_DECLS
+
+typedef struct
+{
+  xcb_randr_output_t                 id;
+  xcb_randr_get_output_info_reply_t *info;
+  char                              *name;
+
+  GBytes                            *edid;
+  gboolean                           hotplug_mode_update;
+  int                                suggested_x;
+  int                                suggested_y;
+  GfConnectorType                    connector_type;
+  GfMonitorTransform                 panel_orientation_transform;
+  GfTileInfo                         tile_info;
+
+  gboolean                           is_presentation;
+  gboolean                           is_underscanning;
+  gboolean                           supports_underscanning;
+
+  gboolean                           has_max_bpc;
+  unsigned int                       max_bpc;
+  unsigned int                       max_bpc_min;
+  unsigned int                       max_bpc_max;
+
+  gboolean                           supports_color_transform;
+
+  int                                backlight;
+  int                                backlight_min;
+  int                                backlight_max;
+} GfXrandrOutput;
+
+GPtrArray *gf_xrandr_reader_read_outputs (Display            *xdisplay,
+                                          XRRScreenResources *resources,
+                                          gboolean            read_tile_info);
+
+G_END_DECLS
+
+#endif
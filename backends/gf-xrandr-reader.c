@@ -0,0 +1,583 @@
+/*
+ * Copyright (C) 2013-2017 Red Hat Inc.
+ * Copyright (C) 2019 Alberts Muktupāvels
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "gf-xrandr-reader-private.h"
+
+#include <X11/Xlib-xcb.h>
+
+#define ALL_ITEMS G_MAXUINT32
+
+typedef enum
+{
+  PROP_EDID,
+  PROP_EDID_DATA,
+  PROP_HOTPLUG_MODE_UPDATE,
+  PROP_SUGGESTED_X,
+  PROP_SUGGESTED_Y,
+  PROP_CONNECTOR_TYPE,
+  PROP_PANEL_ORIENTATION,
+  PROP_TILE,
+  PROP_PRESENTATION,
+  PROP_UNDERSCAN,
+  PROP_MAX_BPC,
+  PROP_CTM,
+  PROP_BACKLIGHT,
+
+  N_PROPS
+} Prop;
+
+typedef enum
+{
+  VALUE_ON,
+  VALUE_UPSIDE_DOWN,
+  VALUE_LEFT_SIDE_UP,
+  VALUE_RIGHT_SIDE_UP,
+
+  N_VALUES
+} Value;
+
+static const struct
+{
+  const char *name;
+  xcb_atom_t  type;
+  uint32_t    length;
+} prop_requests[N_PROPS] =
+{
+  [PROP_EDID] = { "EDID", XCB_GET_PROPERTY_TYPE_ANY, 100 },
+  [PROP_EDID_DATA] = { "EDID_DATA", XCB_GET_PROPERTY_TYPE_ANY, 100 },
+  [PROP_HOTPLUG_MODE_UPDATE] = { "hotplug_mode_update", XCB_GET_PROPERTY_TYPE_ANY, ALL_ITEMS },
+  [PROP_SUGGESTED_X] = { "suggested X", XCB_ATOM_INTEGER, ALL_ITEMS },
+  [PROP_SUGGESTED_Y] = { "suggested Y", XCB_ATOM_INTEGER, ALL_ITEMS },
+  [PROP_CONNECTOR_TYPE] = { "ConnectorType", XCB_ATOM_ATOM, ALL_ITEMS },
+  [PROP_PANEL_ORIENTATION] = { "panel orientation", XCB_ATOM_ATOM, ALL_ITEMS },
+  [PROP_TILE] = { "TILE", XCB_GET_PROPERTY_TYPE_ANY, 100 },
+  [PROP_PRESENTATION] = { "_GNOME_FLASHBACK_PRESENTATION_OUTPUT", XCB_ATOM_CARDINAL, ALL_ITEMS },
+  [PROP_UNDERSCAN] = { "underscan", XCB_ATOM_ATOM, ALL_ITEMS },
+  [PROP_MAX_BPC] = { "max bpc", XCB_ATOM_INTEGER, ALL_ITEMS },
+  [PROP_CTM] = { "CTM", XCB_ATOM_INTEGER, ALL_ITEMS },
+  [PROP_BACKLIGHT] = { "Backlight", XCB_ATOM_INTEGER, ALL_ITEMS }
+};
+
+static const char *value_names[N_VALUES] =
+{
+  [VALUE_ON] = "on",
+  [VALUE_UPSIDE_DOWN] = "Upside Down",
+  [VALUE_LEFT_SIDE_UP] = "Left Side Up",
+  [VALUE_RIGHT_SIDE_UP] = "Right Side Up"
+};
+
+static const struct
+{
+  const char      *name;
+  GfConnectorType  type;
+} connector_types[] =
+{
+  { "HDMI", GF_CONNECTOR_TYPE_HDMIA },
+  { "VGA", GF_CONNECTOR_TYPE_VGA },
+  /* Doesn't have a DRM equivalent, but means an internal panel.
+   * We could pick either LVDS or eDP here. */
+  { "Panel", GF_CONNECTOR_TYPE_LVDS },
+  { "DVI", GF_CONNECTOR_TYPE_DVII },
+  { "DVI-I", GF_CONNECTOR_TYPE_DVII },
+  { "DVI-A", GF_CONNECTOR_TYPE_DVIA },
+  { "DVI-D", GF_CONNECTOR_TYPE_DVID },
+  { "DisplayPort", GF_CONNECTOR_TYPE_DisplayPort },
+  { "TV", GF_CONNECTOR_TYPE_TV },
+  { "TV-Composite", GF_CONNECTOR_TYPE_Composite },
+  { "TV-SVideo", GF_CONNECTOR_TYPE_SVIDEO },
+  /* Another set of mismatches. */
+  { "TV-SCART", GF_CONNECTOR_TYPE_TV },
+  { "TV-C4", GF_CONNECTOR_TYPE_TV }
+};
+
+typedef struct
+{
+  Atom props[N_PROPS];
+  Atom values[N_VALUES];
+  Atom connector_types[G_N_ELEMENTS (connector_types)];
+} Atoms;
+
+typedef struct
+{
+  xcb_randr_get_output_info_cookie_t       info;
+  xcb_randr_get_output_property_cookie_t   props[N_PROPS];
+  xcb_randr_query_output_property_cookie_t underscan;
+  xcb_randr_query_output_property_cookie_t max_bpc;
+  xcb_randr_query_output_property_cookie_t backlight;
+} OutputCookies;
+
+static void
+xrandr_output_free (GfXrandrOutput *output)
+{
+  g_free (output->info);
+  g_free (output->name);
+  g_clear_pointer (&output->edid, g_bytes_unref);
+  g_free (output);
+}
+
+static void
+intern_atoms (Display *xdisplay,
+              Atoms   *atoms)
+{
+  char *names[N_PROPS + N_VALUES + G_N_ELEMENTS (connector_types)];
+  guint i;
+
+  /* Xlib caches interned atoms, so this only costs a round trip once */
+  for (i = 0; i < N_PROPS; i++)
+    names[i] = (char *) prop_requests[i].name;
+
+  XInternAtoms (xdisplay, names, N_PROPS, False, atoms->props);
+
+  for (i = 0; i < N_VALUES; i++)
+    names[i] = (char *) value_names[i];
+
+  for (i = 0; i < G_N_ELEMENTS (connector_types); i++)
+    names[N_VALUES + i] = (char *) connector_types[i].name;
+
+  XInternAtoms (xdisplay, names, N_VALUES, True, atoms->values);
+  XInternAtoms (xdisplay, names + N_VALUES, G_N_ELEMENTS (connector_types),
+                True, atoms->connector_types);
+}
+
+static void
+send_requests (xcb_connection_t   *xcb_conn,
+               const Atoms        *atoms,
+               xcb_randr_output_t  output_id,
+               xcb_timestamp_t     config_timestamp,
+               gboolean            read_tile_info,
+               OutputCookies      *cookies)
+{
+  int i;
+
+  cookies->info = xcb_randr_get_output_info (xcb_conn,
+                                             output_id,
+                                             config_timestamp);
+
+  for (i = 0; i < N_PROPS; i++)
+    {
+      if (i == PROP_TILE && !read_tile_info)
+        continue;
+
+      cookies->props[i] = xcb_randr_get_output_property (xcb_conn,
+                                                         output_id,
+                                                         atoms->props[i],
+                                                         prop_requests[i].type,
+                                                         0,
+                                                         prop_requests[i].length,
+                                                         FALSE,
+                                                         FALSE);
+    }
+
+  cookies->underscan = xcb_randr_query_output_property (xcb_conn,
+                                                        output_id,
+                                                        atoms->props[PROP_UNDERSCAN]);
+
+  cookies->max_bpc = xcb_randr_query_output_property (xcb_conn,
+                                                      output_id,
+                                                      atoms->props[PROP_MAX_BPC]);
+
+  cookies->backlight = xcb_randr_query_output_property (xcb_conn,
+                                                        output_id,
+                                                        atoms->props[PROP_BACKLIGHT]);
+}
+
+static xcb_randr_get_output_property_reply_t *
+get_property_reply (xcb_connection_t                       *xcb_conn,
+                    xcb_randr_get_output_property_cookie_t  cookie)
+{
+  xcb_randr_get_output_property_reply_t *reply;
+  xcb_generic_error_t *xcb_error;
+
+  xcb_error = NULL;
+  reply = xcb_randr_get_output_property_reply (xcb_conn, cookie, &xcb_error);
+  g_free (xcb_error);
+
+  return reply;
+}
+
+static xcb_randr_query_output_property_reply_t *
+query_property_reply (xcb_connection_t                         *xcb_conn,
+                      xcb_randr_query_output_property_cookie_t  cookie)
+{
+  xcb_randr_query_output_property_reply_t *reply;
+  xcb_generic_error_t *xcb_error;
+
+  /* Fails with BadName for properties the output does not have */
+  xcb_error = NULL;
+  reply = xcb_randr_query_output_property_reply (xcb_conn, cookie, &xcb_error);
+  g_free (xcb_error);
+
+  return reply;
+}
+
+static const void *
+get_property_data (xcb_randr_get_output_property_reply_t *reply,
+                   xcb_atom_t                             type,
+                   uint8_t                                format,
+                   uint32_t                              *n_items)
+{
+  if (reply == NULL || reply->type != type || reply->format != format)
+    return NULL;
+
+  *n_items = reply->num_items;
+
+  return xcb_randr_get_output_property_data (reply);
+}
+
+static GBytes *
+read_edid (xcb_randr_get_output_property_reply_t *edid,
+           xcb_randr_get_output_property_reply_t *edid_data)
+{
+  const uint8_t *data;
+  uint32_t len;
+
+  data = get_property_data (edid, XCB_ATOM_INTEGER, 8, &len);
+
+  if (data == NULL)
+    data = get_property_data (edid_data, XCB_ATOM_INTEGER, 8, &len);
+
+  if (data == NULL || len == 0 || len % 128 != 0)
+    return NULL;
+
+  return g_bytes_new (data, len);
+}
+
+static int
+read_integer (xcb_randr_get_output_property_reply_t *reply,
+              int                                    default_value)
+{
+  const int32_t *data;
+  uint32_t n_items;
+
+  data = get_property_data (reply, XCB_ATOM_INTEGER, 32, &n_items);
+
+  if (data == NULL || n_items != 1)
+    return default_value;
+
+  return data[0];
+}
+
+static xcb_atom_t
+read_atom (xcb_randr_get_output_property_reply_t *reply)
+{
+  const xcb_atom_t *data;
+  uint32_t n_items;
+
+  data = get_property_data (reply, XCB_ATOM_ATOM, 32, &n_items);
+
+  if (data == NULL || n_items < 1)
+    return XCB_ATOM_NONE;
+
+  return data[0];
+}
+
+static GfConnectorType
+read_connector_type (const Atoms                           *atoms,
+                     xcb_randr_get_output_property_reply_t *reply)
+{
+  xcb_atom_t atom;
+  guint i;
+
+  atom = read_atom (reply);
+  if (atom == XCB_ATOM_NONE)
+    return GF_CONNECTOR_TYPE_Unknown;
+
+  for (i = 0; i < G_N_ELEMENTS (connector_types); i++)
+    {
+      if (atom == atoms->connector_types[i])
+        return connector_types[i].type;
+    }
+
+  return GF_CONNECTOR_TYPE_Unknown;
+}
+
+static GfMonitorTransform
+read_panel_orientation_transform (const Atoms                           *atoms,
+                                  xcb_randr_get_output_property_reply_t *reply)
+{
+  xcb_atom_t atom;
+
+  atom = read_atom (reply);
+  if (atom == XCB_ATOM_NONE)
+    return GF_MONITOR_TRANSFORM_NORMAL;
+
+  if (atom == atoms->values[VALUE_UPSIDE_DOWN])
+    return GF_MONITOR_TRANSFORM_180;
+  else if (atom == atoms->values[VALUE_LEFT_SIDE_UP])
+    return GF_MONITOR_TRANSFORM_90;
+  else if (atom == atoms->values[VALUE_RIGHT_SIDE_UP])
+    return GF_MONITOR_TRANSFORM_270;
+
+  return GF_MONITOR_TRANSFORM_NORMAL;
+}
+
+static void
+read_tile (GfTileInfo                            *tile_info,
+           xcb_randr_get_output_property_reply_t *reply)
+{
+  const uint32_t *data;
+  uint32_t n_items;
+
+  data = get_property_data (reply, XCB_ATOM_INTEGER, 32, &n_items);
+
+  if (data == NULL || n_items != 8)
+    return;
+
+  tile_info->group_id = data[0];
+  tile_info->flags = data[1];
+  tile_info->max_h_tiles = data[2];
+  tile_info->max_v_tiles = data[3];
+  tile_info->loc_h_tile = data[4];
+  tile_info->loc_v_tile = data[5];
+  tile_info->tile_w = data[6];
+  tile_info->tile_h = data[7];
+}
+
+static gboolean
+read_supports_underscanning (const Atoms                             *atoms,
+                             xcb_randr_get_output_property_reply_t   *reply,
+                             xcb_randr_query_output_property_reply_t *query)
+{
+  const xcb_atom_t *valid_values;
+  int n_valid_values;
+  int i;
+
+  if (read_atom (reply) == XCB_ATOM_NONE || query == NULL)
+    return FALSE;
+
+  valid_values = (const xcb_atom_t *) xcb_randr_query_output_property_valid_values (query);
+  n_valid_values = xcb_randr_query_output_property_valid_values_length (query);
+
+  /* The output supports underscanning if "on" is a valid value
+   * for the underscan property.
+   */
+  for (i = 0; i < n_valid_values; i++)
+    {
+      if (valid_values[i] == atoms->values[VALUE_ON])
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+read_range (xcb_randr_query_output_property_reply_t *query,
+            int                                     *min,
+            int                                     *max)
+{
+  const int32_t *valid_values;
+
+  if (query == NULL ||
+      xcb_randr_query_output_property_valid_values_length (query) != 2)
+    return FALSE;
+
+  valid_values = xcb_randr_query_output_property_valid_values (query);
+
+  *min = valid_values[0];
+  *max = valid_values[1];
+
+  return TRUE;
+}
+
+static void
+read_properties (GfXrandrOutput                           *output,
+                 const Atoms                              *atoms,
+                 xcb_randr_get_output_property_reply_t   **replies,
+                 xcb_randr_query_output_property_reply_t  *underscan,
+                 xcb_randr_query_output_property_reply_t  *max_bpc,
+                 xcb_randr_query_output_property_reply_t  *backlight)
+{
+  const uint32_t *data;
+  uint32_t n_items;
+  xcb_atom_t atom;
+  int min;
+  int max;
+
+  output->edid = read_edid (replies[PROP_EDID], replies[PROP_EDID_DATA]);
+
+  output->hotplug_mode_update = replies[PROP_HOTPLUG_MODE_UPDATE] != NULL &&
+                                replies[PROP_HOTPLUG_MODE_UPDATE]->type != XCB_ATOM_NONE;
+
+  output->suggested_x = read_integer (replies[PROP_SUGGESTED_X], -1);
+  output->suggested_y = read_integer (replies[PROP_SUGGESTED_Y], -1);
+
+  output->connector_type = read_connector_type (atoms,
+                                                replies[PROP_CONNECTOR_TYPE]);
+
+  output->panel_orientation_transform = read_panel_orientation_transform (atoms,
+                                                                          replies[PROP_PANEL_ORIENTATION]);
+
+  read_tile (&output->tile_info, replies[PROP_TILE]);
+
+  data = get_property_data (replies[PROP_PRESENTATION],
+                            XCB_ATOM_CARDINAL, 32, &n_items);
+  output->is_presentation = data != NULL && n_items >= 1 && data[0] != 0;
+
+  atom = read_atom (replies[PROP_UNDERSCAN]);
+  output->is_underscanning = atom != XCB_ATOM_NONE &&
+                             atom == atoms->values[VALUE_ON];
+  output->supports_underscanning = read_supports_underscanning (atoms,
+                                                                replies[PROP_UNDERSCAN],
+                                                                underscan);
+
+  data = get_property_data (replies[PROP_MAX_BPC],
+                            XCB_ATOM_INTEGER, 32, &n_items);
+  if (data != NULL && n_items >= 1)
+    {
+      output->has_max_bpc = TRUE;
+      output->max_bpc = data[0];
+    }
+
+  if (replies[PROP_MAX_BPC] != NULL &&
+      replies[PROP_MAX_BPC]->type != XCB_ATOM_NONE &&
+      read_range (max_bpc, &min, &max))
+    {
+      output->max_bpc_min = min;
+      output->max_bpc_max = max;
+    }
+
+  /* X's CTM property is 9 64-bit integers represented as an array of 18
+   * 32-bit integers.
+   */
+  data = get_property_data (replies[PROP_CTM], XCB_ATOM_INTEGER, 32, &n_items);
+  output->supports_color_transform = data != NULL && n_items == 18;
+
+  data = get_property_data (replies[PROP_BACKLIGHT],
+                            XCB_ATOM_INTEGER, 32, &n_items);
+  output->backlight = data != NULL && n_items >= 1 ? (int) data[0] : -1;
+
+  /* This can happen on systems without backlights. */
+  if (backlight == NULL)
+    return;
+
+  if (!backlight->range || !read_range (backlight, &min, &max))
+    {
+      g_warning ("backlight %s was not range", output->name);
+      return;
+    }
+
+  output->backlight_min = min;
+  output->backlight_max = max;
+}
+
+static GfXrandrOutput *
+collect_replies (xcb_connection_t   *xcb_conn,
+                 const Atoms        *atoms,
+                 xcb_randr_output_t  output_id,
+                 gboolean            read_tile_info,
+                 OutputCookies      *cookies)
+{
+  xcb_randr_get_output_info_reply_t *info;
+  xcb_generic_error_t *xcb_error;
+  xcb_randr_get_output_property_reply_t *replies[N_PROPS];
+  xcb_randr_query_output_property_reply_t *underscan;
+  xcb_randr_query_output_property_reply_t *max_bpc;
+  xcb_randr_query_output_property_reply_t *backlight;
+  GfXrandrOutput *output;
+  int i;
+
+  xcb_error = NULL;
+  info = xcb_randr_get_output_info_reply (xcb_conn, cookies->info, &xcb_error);
+  g_free (xcb_error);
+
+  for (i = 0; i < N_PROPS; i++)
+    {
+      if (i == PROP_TILE && !read_tile_info)
+        replies[i] = NULL;
+      else
+        replies[i] = get_property_reply (xcb_conn, cookies->props[i]);
+    }
+
+  underscan = query_property_reply (xcb_conn, cookies->underscan);
+  max_bpc = query_property_reply (xcb_conn, cookies->max_bpc);
+  backlight = query_property_reply (xcb_conn, cookies->backlight);
+
+  output = NULL;
+
+  if (info != NULL)
+    {
+      output = g_new0 (GfXrandrOutput, 1);
+
+      output->id = output_id;
+      output->info = info;
+      output->name = g_strndup ((const char *) xcb_randr_get_output_info_name (info),
+                                xcb_randr_get_output_info_name_length (info));
+
+      read_properties (output, atoms, replies, underscan, max_bpc, backlight);
+    }
+
+  for (i = 0; i < N_PROPS; i++)
+    g_free (replies[i]);
+
+  g_free (underscan);
+  g_free (max_bpc);
+  g_free (backlight);
+
+  return output;
+}
+
+GPtrArray *
+gf_xrandr_reader_read_outputs (Display            *xdisplay,
+                               XRRScreenResources *resources,
+                               gboolean            read_tile_info)
+{
+  xcb_connection_t *xcb_conn;
+  Atoms atoms;
+  OutputCookies *cookies;
+  GPtrArray *outputs;
+  int i;
+
+  xcb_conn = XGetXCBConnection (xdisplay);
+  intern_atoms (xdisplay, &atoms);
+
+  cookies = g_new0 (OutputCookies, resources->noutput);
+
+  /* Send all requests before waiting for any reply, so reading every
+   * output costs a single round trip instead of dozens per output.
+   */
+  for (i = 0; i < resources->noutput; i++)
+    {
+      send_requests (xcb_conn,
+                     &atoms,
+                     resources->outputs[i],
+                     resources->configTimestamp,
+                     read_tile_info,
+                     &cookies[i]);
+    }
+
+  outputs = g_ptr_array_new_with_free_func ((GDestroyNotify) xrandr_output_free);
+
+  for (i = 0; i < resources->noutput; i++)
+    {
+      GfXrandrOutput *output;
+
+      output = collect_replies (xcb_conn,
+                                &atoms,
+                                resources->outputs[i],
+                                read_tile_info,
+                                &cookies[i]);
+
+      if (output != NULL)
+        g_ptr_array_add (outputs, output);
+    }
+
+  g_free (cookies);
+
+  return outputs;
+}
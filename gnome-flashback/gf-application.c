@@ -269,6 +269,10 @@ settings_changed (GSettings   *settings,
     gf_input_settings_set_monitor_manager (application->input_settings,
                                            monitor_manager);
 
+  if (application->notifications)
+    gf_notifications_set_monitor_manager (application->notifications,
+                                          monitor_manager);
+
   if (application->screensaver)
     {
       gf_screensaver_set_monitor_manager (application->screensaver,
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GF_BG_KERNELS_PRIVATE_H
+#define GF_BG_KERNELS_PRIVATE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void gf_bg_sum_row_xrgb       (const guint32 *p,
+                               int            width,
+                               guint64       *r_total,
+                               guint64       *g_total,
+                               guint64       *b_total);
+
+void gf_bg_convert_row_rgb    (const guchar  *src,
+                               guint32       *dest,
+                               int            width);
+
+void gf_bg_composite_row_rgba (const guchar  *src,
+                               guint32       *dest,
+                               int            width);
+
+void gf_bg_blend_row          (const guchar  *src,
+                               const guchar  *base,
+                               guchar        *dest,
+                               int            n_bytes,
+                               guint          alpha);
+
+void gf_bg_fill_row           (guchar        *dest,
+                               const guchar  *pattern,
+                               int            pattern_bytes,
+                               int            n_bytes);
+
+G_END_DECLS
+
+#endif
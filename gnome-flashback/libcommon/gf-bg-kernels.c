@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "gf-bg-kernels-private.h"
+
+#include <string.h>
+
+/* Pixel loops are additionally built for AVX2 and picked at runtime */
+#if defined (__x86_64__) && defined (__has_attribute)
+#if __has_attribute (target_clones)
+#define GF_BG_VECTORIZE __attribute__ ((target_clones ("avx2", "default")))
+#endif
+#endif
+
+#ifndef GF_BG_VECTORIZE
+#define GF_BG_VECTORIZE
+#endif
+
+GF_BG_VECTORIZE void
+gf_bg_sum_row_xrgb (const guint32 *p,
+                    int            width,
+                    guint64       *r_total,
+                    guint64       *g_total,
+                    guint64       *b_total)
+{
+  guint32 r;
+  guint32 g;
+  guint32 b;
+  int i;
+
+  /* 32 bit sums do not overflow for rows narrower than 16M pixels */
+  r = g = b = 0;
+
+  for (i = 0; i < width; i++)
+    {
+      r += (p[i] >> 16) & 0xFF;
+      g += (p[i] >> 8) & 0xFF;
+      b += p[i] & 0xFF;
+    }
+
+  *r_total += r;
+  *g_total += g;
+  *b_total += b;
+}
+
+GF_BG_VECTORIZE void
+gf_bg_convert_row_rgb (const guchar *src,
+                       guint32      *dest,
+                       int           width)
+{
+  int i;
+
+  for (i = 0; i < width; i++)
+    {
+      dest[i] = 0xFF000000 |
+                (src[3 * i + 0] << 16) |
+                (src[3 * i + 1] << 8) |
+                src[3 * i + 2];
+    }
+}
+
+GF_BG_VECTORIZE void
+gf_bg_composite_row_rgba (const guchar *src,
+                          guint32      *dest,
+                          int           width)
+{
+  int i;
+
+  for (i = 0; i < width; i++)
+    {
+      guint alpha;
+      guint inverse;
+      guint r;
+      guint g;
+      guint b;
+
+      alpha = src[4 * i + 3];
+      inverse = 0xFF - alpha;
+
+      r = src[4 * i + 0] * alpha + ((dest[i] >> 16) & 0xFF) * inverse + 0x80;
+      g = src[4 * i + 1] * alpha + ((dest[i] >> 8) & 0xFF) * inverse + 0x80;
+      b = src[4 * i + 2] * alpha + (dest[i] & 0xFF) * inverse + 0x80;
+
+      dest[i] = 0xFF000000 |
+                (((r + (r >> 8)) >> 8) << 16) |
+                (((g + (g >> 8)) >> 8) << 8) |
+                ((b + (b >> 8)) >> 8);
+    }
+}
+
+GF_BG_VECTORIZE void
+gf_bg_blend_row (const guchar *src,
+                 const guchar *base,
+                 guchar       *dest,
+                 int           n_bytes,
+                 guint         alpha)
+{
+  guint inverse;
+  int i;
+
+  inverse = 0xFF - alpha;
+
+  for (i = 0; i < n_bytes; i++)
+    {
+      guint value;
+
+      value = src[i] * alpha + base[i] * inverse + 0x80;
+      dest[i] = (value + (value >> 8)) >> 8;
+    }
+}
+
+void
+gf_bg_fill_row (guchar       *dest,
+                const guchar *pattern,
+                int           pattern_bytes,
+                int           n_bytes)
+{
+  int filled;
+
+  /* Copies grow exponentially, memcpy does the vector work */
+  filled = MIN (pattern_bytes, n_bytes);
+
+  if (dest != pattern)
+    memcpy (dest, pattern, filled);
+
+  while (filled < n_bytes)
+    {
+      int n;
+
+      n = MIN (filled, n_bytes - filled);
+      memcpy (dest + filled, dest, n);
+      filled += n;
+    }
+}
@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "gf-bg.h"
+#include "gf-bg-kernels-private.h"
 
 #include <string.h>
 #include <math.h>
@@ -57,8 +58,20 @@
 #define KEEP_EXPENSIVE_CACHE_SECS 60
 
 typedef struct FileCacheEntry FileCacheEntry;
+typedef struct Transition Transition;
 #define CACHE_SIZE 4
 
+/* Scaled wallpapers stored as raw pixels, oldest evicted first */
+#define WALLPAPER_CACHE_MAGIC "GFWC"
+#define WALLPAPER_CACHE_SUFFIX ".gfwc"
+#define WALLPAPER_CACHE_VERSION 1
+#define WALLPAPER_CACHE_MAX_BYTES (256 * 1024 * 1024)
+
+/* Rendered backgrounds shared by all GfBG instances in the process. They
+ * are full-screen surfaces, a 4K screen alone takes about 32 MiB, so the
+ * cache is bounded by size. The most recent entry is always kept. */
+#define RENDER_CACHE_MAX_BYTES (48 * 1024 * 1024)
+
 struct _GfBG
 {
 	GObject                 parent_instance;
@@ -86,9 +99,19 @@ struct _GfBG
         GnomeBGSlideShow *	slideshow;
 	time_t			file_mtime;
 	GdkPixbuf *		pixbuf_cache;
+	int			pixbuf_cache_width;
+	int			pixbuf_cache_height;
 	int			timeout_id;
 
 	GList *		        file_cache;
+
+	/* Slideshow cross-fade state, shared with snapshots */
+	Transition *		transition;
+
+	/* Snapshots are private copies used to render in a worker thread */
+	gboolean                snapshot;
+	double                  snapshot_timeout;
+	gboolean                snapshot_blow_caches;
 };
 
 enum
@@ -120,13 +143,12 @@ static GdkPixbuf *pixbuf_scale_to_fit  (GdkPixbuf  *src,
 static GdkPixbuf *pixbuf_scale_to_min  (GdkPixbuf  *src,
 					int         min_width,
 					int         min_height);
-static void       pixbuf_draw_gradient (GdkPixbuf    *pixbuf,
-					gboolean      horizontal,
-					GdkRGBA      *c1,
-					GdkRGBA      *c2,
-					GdkRectangle *rect);
-static void       pixbuf_tile          (GdkPixbuf  *src,
-					GdkPixbuf  *dest);
+static void       surface_blit         (GdkPixbuf       *src,
+					cairo_surface_t *dest,
+					int              dest_x,
+					int              dest_y);
+static void       surface_tile         (GdkPixbuf       *src,
+					cairo_surface_t *dest);
 static void       pixbuf_blend         (GdkPixbuf  *src,
 					GdkPixbuf  *dest,
 					int         src_x,
@@ -136,6 +158,11 @@ static void       pixbuf_blend         (GdkPixbuf  *src,
 					int         dest_x,
 					int         dest_y,
 					double      alpha);
+static GdkPixbuf *transition_blend     (Transition *transition,
+					GdkPixbuf  *p1,
+					GdkPixbuf  *p2,
+					double      alpha);
+static void       transition_drop_target (Transition *transition);
 
 static GdkPixbuf *get_pixbuf_for_size  (GfBG                  *bg,
 					gint                   num_monitor,
@@ -171,6 +198,8 @@ do_changed (GfBG *bg)
 {
 	bg->changed_id = 0;
 
+	transition_drop_target (bg->transition);
+
 	g_signal_emit (G_OBJECT (bg), signals[CHANGED], 0);
 
 	return FALSE;
@@ -255,7 +284,8 @@ bg_gsettings_mapping (GVariant *value,
 static inline gchar *
 get_wallpaper_cache_dir (void)
 {
-	return g_build_filename (g_get_user_cache_dir(), "wallpaper", NULL);
+	return g_build_filename (g_get_user_cache_dir (), "gnome-flashback",
+	                         "wallpaper", NULL);
 }
 
 static inline gchar *
@@ -282,7 +312,7 @@ get_wallpaper_cache_filename (const char              *filename,
 
 	md5_filename = g_compute_checksum_for_data (G_CHECKSUM_MD5, (const guchar *) filename, strlen (filename));
 	cache_prefix_name = get_wallpaper_cache_prefix_name (num_monitor, placement, width, height);
-	cache_basename = g_strdup_printf ("%s_%s", cache_prefix_name, md5_filename);
+	cache_basename = g_strdup_printf ("%s_%s" WALLPAPER_CACHE_SUFFIX, cache_prefix_name, md5_filename);
 	cache_dir = get_wallpaper_cache_dir ();
 	cache_filename = g_build_filename (cache_dir, cache_basename, NULL);
 
@@ -294,36 +324,338 @@ get_wallpaper_cache_filename (const char              *filename,
 	return cache_filename;
 }
 
+typedef struct
+{
+  char    magic[4];
+  guint32 version;
+  guint32 width;
+  guint32 height;
+  guint32 rowstride;
+  guint32 has_alpha;
+} WallpaperCacheHeader;
+
+typedef struct
+{
+  char   *path;
+  goffset size;
+  gint64  mtime;
+} WallpaperCacheFile;
+
+typedef struct
+{
+  GdkPixbuf *pixbuf;
+  char      *cache_filename;
+} WallpaperCacheWrite;
+
+static GMutex cache_writes_lock;
+static GHashTable *cache_writes;
+
+static GdkPixbuf *
+read_cache_file (const char *cache_filename)
+{
+  GMappedFile *file;
+  GBytes *bytes;
+  const WallpaperCacheHeader *header;
+  gsize size;
+  GdkPixbuf *pixbuf;
+
+  file = g_mapped_file_new (cache_filename, FALSE, NULL);
+  if (file == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  header = g_bytes_get_data (bytes, &size);
+  pixbuf = NULL;
+
+  if (size >= sizeof (*header) &&
+      memcmp (header->magic, WALLPAPER_CACHE_MAGIC, 4) == 0 &&
+      header->version == WALLPAPER_CACHE_VERSION &&
+      header->width > 0 && header->height > 0 &&
+      header->rowstride >= (guint64) header->width * (header->has_alpha ? 4 : 3) &&
+      size - sizeof (*header) >= (guint64) header->rowstride * header->height)
+    {
+      GBytes *pixels;
+
+      /* The pixbuf keeps the mapping alive */
+      pixels = g_bytes_new_from_bytes (bytes,
+                                       sizeof (*header),
+                                       (gsize) header->rowstride * header->height);
+
+      pixbuf = gdk_pixbuf_new_from_bytes (pixels,
+                                          GDK_COLORSPACE_RGB,
+                                          header->has_alpha,
+                                          8,
+                                          header->width,
+                                          header->height,
+                                          header->rowstride);
+
+      g_bytes_unref (pixels);
+    }
+
+  g_bytes_unref (bytes);
+
+  return pixbuf;
+}
+
+static gboolean
+write_cache_file (GdkPixbuf   *pixbuf,
+                  const char  *cache_filename,
+                  GError     **error)
+{
+  GFile *file;
+  GFileOutputStream *stream;
+  WallpaperCacheHeader header;
+  const guint8 *pixels;
+  int src_rowstride;
+  int row_bytes;
+  guint8 padding[4] = { 0 };
+  int i;
+  gboolean ret;
+
+  file = g_file_new_for_path (cache_filename);
+
+  /* Written to a temporary file and renamed over the old one on close */
+  stream = g_file_replace (file,
+                           NULL,
+                           FALSE,
+                           G_FILE_CREATE_PRIVATE |
+                           G_FILE_CREATE_REPLACE_DESTINATION,
+                           NULL,
+                           error);
+
+  g_object_unref (file);
+
+  if (stream == NULL)
+    return FALSE;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, WALLPAPER_CACHE_MAGIC, 4);
+  header.version = WALLPAPER_CACHE_VERSION;
+  header.width = gdk_pixbuf_get_width (pixbuf);
+  header.height = gdk_pixbuf_get_height (pixbuf);
+  header.has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
+
+  row_bytes = header.width * (header.has_alpha ? 4 : 3);
+  header.rowstride = (row_bytes + 3) & ~3;
+
+  pixels = gdk_pixbuf_read_pixels (pixbuf);
+  src_rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+  ret = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                   &header,
+                                   sizeof (header),
+                                   NULL,
+                                   NULL,
+                                   error);
+
+  for (i = 0; ret && i < (int) header.height; i++)
+    {
+      ret = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                       pixels + i * src_rowstride,
+                                       row_bytes,
+                                       NULL,
+                                       NULL,
+                                       error);
+
+      if (ret && header.rowstride > (guint32) row_bytes)
+        {
+          ret = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                           padding,
+                                           header.rowstride - row_bytes,
+                                           NULL,
+                                           NULL,
+                                           error);
+        }
+    }
+
+  if (ret)
+    ret = g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+
+  g_object_unref (stream);
+
+  return ret;
+}
+
+static int
+compare_cache_files (gconstpointer a,
+                     gconstpointer b)
+{
+  const WallpaperCacheFile *file_a;
+  const WallpaperCacheFile *file_b;
+
+  file_a = a;
+  file_b = b;
+
+  if (file_a->mtime < file_b->mtime)
+    return -1;
+  else if (file_a->mtime > file_b->mtime)
+    return 1;
+
+  return 0;
+}
+
 static void
-cleanup_cache_for_monitor (gchar *cache_dir,
-			   gint   num_monitor)
-{
-	GDir            *g_cache_dir;
-	gchar           *monitor_prefix;
-	const gchar     *file;
-
-	g_cache_dir = g_dir_open (cache_dir, 0, NULL);
-	monitor_prefix = g_strdup_printf ("%i_", num_monitor);
-
-	file = g_dir_read_name (g_cache_dir);
-	while (file != NULL) {
-		gchar *path;
-
-		path = g_build_filename (cache_dir, file, NULL);
-		/* purge files with same monitor id */
-		if (g_str_has_prefix (file, monitor_prefix) &&
-		    g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
-			if (g_unlink (path) != 0)
-				g_warning ("Failed to delete %s", path);
-		}
+clear_cache_file (gpointer data)
+{
+  WallpaperCacheFile *file;
 
-		g_free (path);
+  file = data;
 
-		file = g_dir_read_name (g_cache_dir);
-	}
+  g_free (file->path);
+}
+
+static void
+trim_cache_dir (const char *cache_dir)
+{
+  GDir *dir;
+  GArray *files;
+  goffset total_size;
+  const char *name;
+  guint i;
+
+  dir = g_dir_open (cache_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  files = g_array_new (FALSE, FALSE, sizeof (WallpaperCacheFile));
+  g_array_set_clear_func (files, clear_cache_file);
+
+  total_size = 0;
 
-	g_free (monitor_prefix);
-	g_dir_close (g_cache_dir);
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      WallpaperCacheFile file;
+      GStatBuf buf;
+
+      /* Skip temporary files of writes in progress */
+      if (name[0] == '.')
+        continue;
+
+      file.path = g_build_filename (cache_dir, name, NULL);
+
+      /* Encoded images written by older versions are never read again */
+      if (!g_str_has_suffix (name, WALLPAPER_CACHE_SUFFIX))
+        {
+          g_unlink (file.path);
+          g_free (file.path);
+          continue;
+        }
+
+      if (g_stat (file.path, &buf) != 0 || !S_ISREG (buf.st_mode))
+        {
+          g_free (file.path);
+          continue;
+        }
+
+      file.size = buf.st_size;
+      file.mtime = buf.st_mtime;
+      total_size += file.size;
+
+      g_array_append_val (files, file);
+    }
+
+  g_dir_close (dir);
+
+  if (total_size > WALLPAPER_CACHE_MAX_BYTES)
+    {
+      g_array_sort (files, compare_cache_files);
+
+      for (i = 0; i < files->len && total_size > WALLPAPER_CACHE_MAX_BYTES; i++)
+        {
+          WallpaperCacheFile *file;
+
+          file = &g_array_index (files, WallpaperCacheFile, i);
+
+          if (g_unlink (file->path) != 0)
+            {
+              g_warning ("Failed to delete %s", file->path);
+              continue;
+            }
+
+          total_size -= file->size;
+        }
+    }
+
+  g_array_unref (files);
+}
+
+static void
+wallpaper_cache_write_free (gpointer data)
+{
+  WallpaperCacheWrite *write;
+
+  write = data;
+
+  g_object_unref (write->pixbuf);
+  g_free (write->cache_filename);
+  g_free (write);
+}
+
+static void
+write_cache_file_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  WallpaperCacheWrite *write;
+  char *cache_dir;
+  GError *error;
+
+  write = task_data;
+  cache_dir = get_wallpaper_cache_dir ();
+  error = NULL;
+
+  if (g_mkdir_with_parents (cache_dir, 0700) != 0)
+    g_warning ("Failed to mkdir %s", cache_dir);
+  else if (!write_cache_file (write->pixbuf, write->cache_filename, &error))
+    g_warning ("Failed to write %s: %s", write->cache_filename, error->message);
+  else
+    trim_cache_dir (cache_dir);
+
+  g_clear_error (&error);
+  g_free (cache_dir);
+
+  g_mutex_lock (&cache_writes_lock);
+  g_hash_table_remove (cache_writes, write->cache_filename);
+  g_mutex_unlock (&cache_writes_lock);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+write_cache_file_async (GdkPixbuf  *pixbuf,
+                        const char *cache_filename)
+{
+  WallpaperCacheWrite *write;
+  GTask *task;
+
+  g_mutex_lock (&cache_writes_lock);
+
+  if (cache_writes == NULL)
+    cache_writes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  /* Another monitor or component is already writing this file */
+  if (g_hash_table_contains (cache_writes, cache_filename))
+    {
+      g_mutex_unlock (&cache_writes_lock);
+      return;
+    }
+
+  g_hash_table_add (cache_writes, g_strdup (cache_filename));
+  g_mutex_unlock (&cache_writes_lock);
+
+  write = g_new0 (WallpaperCacheWrite, 1);
+  write->pixbuf = g_object_ref (pixbuf);
+  write->cache_filename = g_strdup (cache_filename);
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_source_tag (task, write_cache_file_async);
+  g_task_set_task_data (task, write, wallpaper_cache_write_free);
+
+  g_task_run_in_thread (task, write_cache_file_thread);
+  g_object_unref (task);
 }
 
 static gboolean
@@ -350,41 +682,22 @@ refresh_cache_file (GfBG      *bg,
                     gint       height)
 {
 	gchar           *cache_filename;
-	gchar           *cache_dir;
 	GdkPixbufFormat *format;
-	gchar           *format_name;
 
 	if ((num_monitor == -1) || (width <= 300) || (height <= 300))
 		return;
 
 	cache_filename = get_wallpaper_cache_filename (bg->filename, num_monitor, bg->placement, width, height);
-	cache_dir = get_wallpaper_cache_dir ();
 
 	/* Only refresh scaled file on disk if useful (and don't cache slideshow) */
 	if (!cache_file_is_valid (bg->filename, cache_filename)) {
 		format = gdk_pixbuf_get_file_info (bg->filename, NULL, NULL);
 
-		if (format != NULL) {
-			if (!g_file_test (cache_dir, G_FILE_TEST_IS_DIR)) {
-				if (g_mkdir_with_parents (cache_dir, 0700) != 0)
-					g_warning ("Failed to mkdir %s", cache_dir);
-			} else {
-				cleanup_cache_for_monitor (cache_dir, num_monitor);
-			}
-
-			format_name = gdk_pixbuf_format_get_name (format);
-
-			if (strcmp (format_name, "jpeg") == 0)
-				gdk_pixbuf_save (new_pixbuf, cache_filename, format_name, NULL, "quality", "100", NULL);
-			else
-				gdk_pixbuf_save (new_pixbuf, cache_filename, format_name, NULL, NULL);
-
-			g_free (format_name);
-		}
+		if (format != NULL)
+			write_cache_file_async (new_pixbuf, cache_filename);
 	}
 
 	g_free (cache_filename);
-	g_free (cache_dir);
 }
 
 static void
@@ -401,83 +714,95 @@ file_changed (GFileMonitor *file_monitor,
 }
 
 static void
-draw_color_area (GfBG         *bg,
-                 GdkPixbuf    *dest,
-                 GdkRectangle *rect)
+draw_color_area (GfBG            *bg,
+                 cairo_surface_t *dest,
+                 GdkRectangle    *rect)
 {
-	guint32 pixel;
-        GdkRectangle extent;
+	cairo_t *cr;
+	cairo_pattern_t *pattern;
 
-        extent.x = 0;
-        extent.y = 0;
-        extent.width = gdk_pixbuf_get_width (dest);
-        extent.height = gdk_pixbuf_get_height (dest);
-
-        if (!gdk_rectangle_intersect (rect, &extent, rect))
-                return;
-	
 	switch (bg->color_type) {
 	case G_DESKTOP_BACKGROUND_SHADING_SOLID:
-		/* not really a big deal to ignore the area of interest */
-		pixel = ((int) (0.5 + bg->primary.red * 255) << 24)      |
-			((int) (0.5 + bg->primary.green * 255) << 16)    |
-			((int) (0.5 + bg->primary.blue * 255) << 8)      |
-			(0xff);
-		
-		gdk_pixbuf_fill (dest, pixel);
+		pattern = cairo_pattern_create_rgb (bg->primary.red,
+		                                    bg->primary.green,
+		                                    bg->primary.blue);
 		break;
-		
+
 	case G_DESKTOP_BACKGROUND_SHADING_HORIZONTAL:
-		pixbuf_draw_gradient (dest, TRUE, &(bg->primary), &(bg->secondary), rect);
+		pattern = cairo_pattern_create_linear (rect->x, 0,
+		                                       rect->x + rect->width, 0);
 		break;
-		
+
 	case G_DESKTOP_BACKGROUND_SHADING_VERTICAL:
-		pixbuf_draw_gradient (dest, FALSE, &(bg->primary), &(bg->secondary), rect);
+		pattern = cairo_pattern_create_linear (0, rect->y,
+		                                       0, rect->y + rect->height);
 		break;
-		
+
 	default:
-		break;
+		return;
+	}
+
+	if (bg->color_type != G_DESKTOP_BACKGROUND_SHADING_SOLID) {
+		cairo_pattern_add_color_stop_rgb (pattern, 0.0,
+		                                  bg->primary.red,
+		                                  bg->primary.green,
+		                                  bg->primary.blue);
+		cairo_pattern_add_color_stop_rgb (pattern, 1.0,
+		                                  bg->secondary.red,
+		                                  bg->secondary.green,
+		                                  bg->secondary.blue);
 	}
+
+	cr = cairo_create (dest);
+	cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source (cr, pattern);
+	gdk_cairo_rectangle (cr, rect);
+	cairo_fill (cr);
+	cairo_destroy (cr);
+
+	cairo_pattern_destroy (pattern);
 }
 
 static void
-draw_color (GfBG      *bg,
-            GdkPixbuf *dest)
+draw_color (GfBG            *bg,
+            cairo_surface_t *dest)
 {
 	GdkRectangle rect;
 	rect.x = 0;
 	rect.y = 0;
-	rect.width = gdk_pixbuf_get_width (dest);
-	rect.height = gdk_pixbuf_get_height (dest);
+	rect.width = cairo_image_surface_get_width (dest);
+	rect.height = cairo_image_surface_get_height (dest);
 	draw_color_area (bg, dest, &rect);
 }
 
-static void
-draw_color_each_monitor (GfBG       *bg,
-                         GdkPixbuf  *dest,
-                         GdkDisplay *display,
-                         gint        scale)
+static GdkRectangle *
+get_monitor_geometries (GdkDisplay *display,
+                        gint        scale,
+                        int        *n_monitors)
 {
-  int n_monitors;
+  GdkRectangle *geometries;
   int i;
 
-  n_monitors = gdk_display_get_n_monitors (display);
+  *n_monitors = gdk_display_get_n_monitors (display);
+  geometries = g_new0 (GdkRectangle, *n_monitors);
 
-  for (i = 0; i < n_monitors; i++)
+  for (i = 0; i < *n_monitors; i++)
     {
       GdkMonitor *monitor;
-      GdkRectangle geometry;
+      GdkRectangle *geometry;
 
       monitor = gdk_display_get_monitor (display, i);
-      gdk_monitor_get_geometry (monitor, &geometry);
+      geometry = &geometries[i];
 
-      geometry.x *= scale;
-      geometry.y *= scale;
-      geometry.width *= scale;
-      geometry.height *= scale;
+      gdk_monitor_get_geometry (monitor, geometry);
 
-      draw_color_area (bg, dest, &geometry);
+      geometry->x *= scale;
+      geometry->y *= scale;
+      geometry->width *= scale;
+      geometry->height *= scale;
     }
+
+  return geometries;
 }
 
 static GdkPixbuf *
@@ -493,7 +818,7 @@ pixbuf_clip_to_fit (GdkPixbuf *src,
 	src_width = gdk_pixbuf_get_width (src);
 	src_height = gdk_pixbuf_get_height (src);
 
-	if (src_width < max_width && src_height < max_height)
+	if (src_width <= max_width && src_height <= max_height)
 		return g_object_ref (src);
 
 	w = MIN(src_width, max_width);
@@ -537,8 +862,12 @@ get_scaled_pixbuf (GDesktopBackgroundStyle placement,
 		break;
 		
 	case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
-		new = gdk_pixbuf_scale_simple (pixbuf, width, height,
-					       GDK_INTERP_BILINEAR);
+		if (gdk_pixbuf_get_width (pixbuf) == width &&
+		    gdk_pixbuf_get_height (pixbuf) == height)
+			new = g_object_ref (pixbuf);
+		else
+			new = gdk_pixbuf_scale_simple (pixbuf, width, height,
+						       GDK_INTERP_BILINEAR);
 		break;
 		
 	case G_DESKTOP_BACKGROUND_STYLE_SCALED:
@@ -566,11 +895,11 @@ get_scaled_pixbuf (GDesktopBackgroundStyle placement,
 }
 
 static void
-draw_image_area (GfBG         *bg,
-                 gint          num_monitor,
-                 GdkPixbuf    *pixbuf,
-                 GdkPixbuf    *dest,
-                 GdkRectangle *area)
+draw_image_area (GfBG            *bg,
+                 gint             num_monitor,
+                 GdkPixbuf       *pixbuf,
+                 cairo_surface_t *dest,
+                 GdkRectangle    *area)
 {
 	int dest_width = area->width;
 	int dest_height = area->height;
@@ -584,16 +913,16 @@ draw_image_area (GfBG         *bg,
 
 	switch (bg->placement) {
 	case G_DESKTOP_BACKGROUND_STYLE_WALLPAPER:
-		pixbuf_tile (scaled, dest);
+		surface_tile (scaled, dest);
 		break;
 	case G_DESKTOP_BACKGROUND_STYLE_ZOOM:
 	case G_DESKTOP_BACKGROUND_STYLE_CENTERED:
 	case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
 	case G_DESKTOP_BACKGROUND_STYLE_SCALED:
-		pixbuf_blend (scaled, dest, 0, 0, w, h, x + area->x, y + area->y, 1.0);
+		surface_blit (scaled, dest, x + area->x, y + area->y);
 		break;
 	case G_DESKTOP_BACKGROUND_STYLE_SPANNED:
-		pixbuf_blend (scaled, dest, 0, 0, w, h, x, y, 1.0);
+		surface_blit (scaled, dest, x, y);
 		break;
 	case G_DESKTOP_BACKGROUND_STYLE_NONE:
 	default:
@@ -607,8 +936,8 @@ draw_image_area (GfBG         *bg,
 }
 
 static void
-draw_once (GfBG      *bg,
-           GdkPixbuf *dest)
+draw_once (GfBG            *bg,
+           cairo_surface_t *dest)
 {
 	GdkRectangle rect;
 	GdkPixbuf   *pixbuf;
@@ -619,8 +948,8 @@ draw_once (GfBG      *bg,
 
 	rect.x = 0;
 	rect.y = 0;
-	rect.width = gdk_pixbuf_get_width (dest);
-	rect.height = gdk_pixbuf_get_height (dest);
+	rect.width = cairo_image_surface_get_width (dest);
+	rect.height = cairo_image_surface_get_height (dest);
 
 	pixbuf = get_pixbuf_for_size (bg, num_monitor, rect.width, rect.height);
 	if (pixbuf) {
@@ -642,61 +971,45 @@ draw_once (GfBG      *bg,
 }
 
 static void
-draw_each_monitor (GfBG       *bg,
-                   GdkPixbuf  *dest,
-                   GdkDisplay *display,
-                   gint        scale)
+draw_monitor (GfBG            *bg,
+              cairo_surface_t *dest,
+              gint             num_monitor)
 {
-  int n_monitors;
-  int i;
-
-  n_monitors = gdk_display_get_n_monitors (display);
+  GdkRectangle geometry;
+  GdkPixbuf *pixbuf;
 
-  for (i = 0; i < n_monitors; i++)
-    {
-      GdkMonitor *monitor;
-      GdkRectangle geometry;
-      GdkPixbuf *pixbuf;
+  geometry.x = 0;
+  geometry.y = 0;
+  geometry.width = cairo_image_surface_get_width (dest);
+  geometry.height = cairo_image_surface_get_height (dest);
 
-      monitor = gdk_display_get_monitor (display, i);
-      gdk_monitor_get_geometry (monitor, &geometry);
-
-      geometry.x *= scale;
-      geometry.y *= scale;
-      geometry.width *= scale;
-      geometry.height *= scale;
+  pixbuf = get_pixbuf_for_size (bg,
+                                num_monitor,
+                                geometry.width,
+                                geometry.height);
 
-      pixbuf = get_pixbuf_for_size (bg, i, geometry.width, geometry.height);
-
-      if (pixbuf != NULL)
-        {
-          draw_image_area (bg, i, pixbuf, dest, &geometry);
-          g_object_unref (pixbuf);
-        }
+  if (pixbuf != NULL)
+    {
+      draw_image_area (bg, num_monitor, pixbuf, dest, &geometry);
+      g_object_unref (pixbuf);
     }
 }
 
+/* Draws a single monitor, or the whole screen if num_monitor is -1 */
 static void
-gf_bg_draw_at_scale (GfBG       *bg,
-                     GdkPixbuf  *dest,
-                     gint        scale,
-                     GdkDisplay *display,
-                     gboolean    is_root)
+gf_bg_draw (GfBG            *bg,
+            cairo_surface_t *dest,
+            gint             num_monitor)
 {
-  if (is_root && (bg->placement != G_DESKTOP_BACKGROUND_STYLE_SPANNED))
-    {
-      draw_color_each_monitor (bg, dest, display, scale);
+  draw_color (bg, dest);
 
-      if (bg->placement != G_DESKTOP_BACKGROUND_STYLE_NONE)
-        draw_each_monitor (bg, dest, display, scale);
-    }
-  else
-    {
-      draw_color (bg, dest);
+  if (bg->placement == G_DESKTOP_BACKGROUND_STYLE_NONE)
+    return;
 
-      if (bg->placement != G_DESKTOP_BACKGROUND_STYLE_NONE)
-        draw_once (bg, dest);
-    }
+  if (num_monitor == -1)
+    draw_once (bg, dest);
+  else
+    draw_monitor (bg, dest, num_monitor);
 }
 
 static void
@@ -750,6 +1063,149 @@ struct _SlideShow
 };
 
 
+struct Transition
+{
+	GMutex           lock;
+
+	/* Slides as decoded and the second one scaled to the first */
+	GdkPixbuf       *from;
+	GdkPixbuf       *to;
+	GdkPixbuf       *to_scaled;
+
+	/* Pixels of the blended step, reused for every step unless the
+	 * pixbuf of a previous step is still alive. The pixbuf owns a
+	 * reference to the transition and clears buffer_in_use when it is
+	 * finalized, a buffer dropped while in use is freed by it instead. */
+	guchar          *buffer;
+	int              buffer_width;
+	int              buffer_height;
+	gboolean         buffer_in_use;
+
+	/* Monitor images given back by the pieces of a frame, the next
+	 * frame draws into them instead of allocating new ones */
+	GPtrArray       *spare_images;
+
+	/* Window-similar surface or root pixmap of the last frame, the next
+	 * frame of the same size repaints it */
+	cairo_surface_t *target;
+	int              target_width;
+	int              target_height;
+	gint             target_scale;
+	gboolean         target_root;
+};
+
+static void
+transition_drop_buffer (Transition *transition)
+{
+	if (!transition->buffer_in_use)
+		g_free (transition->buffer);
+
+	transition->buffer = NULL;
+	transition->buffer_in_use = FALSE;
+}
+
+static void
+transition_clear (Transition *transition)
+{
+	g_clear_object (&transition->from);
+	g_clear_object (&transition->to);
+	g_clear_object (&transition->to_scaled);
+	transition_drop_buffer (transition);
+	g_clear_pointer (&transition->spare_images, g_ptr_array_unref);
+	g_clear_pointer (&transition->target, cairo_surface_destroy);
+}
+
+static void
+transition_free (gpointer data)
+{
+	Transition *transition = data;
+
+	transition_clear (transition);
+	g_mutex_clear (&transition->lock);
+}
+
+static Transition *
+transition_new (void)
+{
+	Transition *transition;
+
+	transition = g_atomic_rc_box_new0 (Transition);
+	g_mutex_init (&transition->lock);
+
+	return transition;
+}
+
+static void
+transition_reset (Transition *transition)
+{
+	g_mutex_lock (&transition->lock);
+	transition_clear (transition);
+	g_mutex_unlock (&transition->lock);
+}
+
+/* The surface of the last frame is not repainted after a change, it is
+ * the start of a fade to the next one */
+static void
+transition_drop_target (Transition *transition)
+{
+	g_mutex_lock (&transition->lock);
+	g_clear_pointer (&transition->target, cairo_surface_destroy);
+	g_mutex_unlock (&transition->lock);
+}
+
+static cairo_surface_t *
+transition_take_image (Transition *transition,
+		       int         width,
+		       int         height)
+{
+	cairo_surface_t *image;
+	guint i;
+
+	image = NULL;
+
+	g_mutex_lock (&transition->lock);
+
+	for (i = 0; transition->spare_images != NULL &&
+		    i < transition->spare_images->len; i++) {
+		cairo_surface_t *spare;
+
+		spare = g_ptr_array_index (transition->spare_images, i);
+
+		if (cairo_image_surface_get_width (spare) == width &&
+		    cairo_image_surface_get_height (spare) == height) {
+			image = g_ptr_array_steal_index_fast (transition->spare_images, i);
+			break;
+		}
+	}
+
+	g_mutex_unlock (&transition->lock);
+
+	return image;
+}
+
+static void
+transition_give_image (Transition      *transition,
+		       cairo_surface_t *image)
+{
+	/* Still painted from somewhere else */
+	if (cairo_surface_get_reference_count (image) != 1) {
+		cairo_surface_destroy (image);
+		return;
+	}
+
+	cairo_surface_set_device_scale (image, 1, 1);
+
+	g_mutex_lock (&transition->lock);
+
+	if (transition->spare_images == NULL)
+		transition->spare_images =
+			g_ptr_array_new_with_free_func ((GDestroyNotify) cairo_surface_destroy);
+
+	g_ptr_array_add (transition->spare_images, image);
+
+	g_mutex_unlock (&transition->lock);
+}
+
 static GdkPixbuf *
 blend (GdkPixbuf *p1,
        GdkPixbuf *p2,
@@ -785,6 +1241,9 @@ struct FileCacheEntry
 {
 	FileType type;
 	char *filename;
+	/* Size of the image on disk, 0 if the pixbuf was not downscaled */
+	int width;
+	int height;
 	union {
 		GdkPixbuf *pixbuf;
 		GnomeBGSlideShow *slideshow;
@@ -842,6 +1301,14 @@ file_cache_lookup (GfBG       *bg,
 	return NULL;
 }
 
+static void
+file_cache_remove (GfBG                 *bg,
+                   const FileCacheEntry *ent)
+{
+	bg->file_cache = g_list_remove (bg->file_cache, ent);
+	file_cache_entry_delete ((FileCacheEntry *) ent);
+}
+
 static FileCacheEntry *
 file_cache_entry_new (GfBG       *bg,
                       FileType    type,
@@ -864,10 +1331,14 @@ file_cache_entry_new (GfBG       *bg,
 static void
 file_cache_add_pixbuf (GfBG       *bg,
                        const char *filename,
-                       GdkPixbuf  *pixbuf)
+                       GdkPixbuf  *pixbuf,
+                       int         width,
+                       int         height)
 {
 	FileCacheEntry *ent = file_cache_entry_new (bg, PIXBUF, filename);
 	ent->u.pixbuf = g_object_ref (pixbuf);
+	ent->width = width;
+	ent->height = height;
 }
 
 static void
@@ -890,13 +1361,93 @@ load_from_cache_file (GfBG       *bg,
 	gchar *cache_filename;
 
 	cache_filename = get_wallpaper_cache_filename (filename, num_monitor, bg->placement, best_width, best_height);
-	if (cache_file_is_valid (filename, cache_filename))
-		pixbuf = gdk_pixbuf_new_from_file (cache_filename, NULL);
+	if (cache_file_is_valid (filename, cache_filename)) {
+		pixbuf = read_cache_file (cache_filename);
+
+		/* The modification time orders the cache for eviction. A file
+		 * that can not be read is removed so it is written again. */
+		if (pixbuf != NULL)
+			g_utime (cache_filename, NULL);
+		else
+			g_unlink (cache_filename);
+	}
 	g_free (cache_filename);
 
 	return pixbuf;
 }
 
+static void
+get_decode_size (GDesktopBackgroundStyle  placement,
+                 int                      width,
+                 int                      height,
+                 int                      best_width,
+                 int                      best_height,
+                 int                     *decode_width,
+                 int                     *decode_height)
+{
+  double factor;
+
+  *decode_width = width;
+  *decode_height = height;
+
+  if (width <= 0 || height <= 0 || best_width <= 0 || best_height <= 0)
+    return;
+
+  switch (placement)
+    {
+      case G_DESKTOP_BACKGROUND_STYLE_SPANNED:
+      case G_DESKTOP_BACKGROUND_STYLE_SCALED:
+        factor = MIN (best_width / (double) width,
+                      best_height / (double) height);
+        break;
+
+      /* Stretched images keep the resolution of the larger axis */
+      case G_DESKTOP_BACKGROUND_STYLE_ZOOM:
+      case G_DESKTOP_BACKGROUND_STYLE_STRETCHED:
+        factor = MAX (best_width / (double) width,
+                      best_height / (double) height);
+        break;
+
+      case G_DESKTOP_BACKGROUND_STYLE_NONE:
+      case G_DESKTOP_BACKGROUND_STYLE_WALLPAPER:
+      case G_DESKTOP_BACKGROUND_STYLE_CENTERED:
+      default:
+        factor = 1.0;
+        break;
+    }
+
+  if (factor >= 1.0)
+    return;
+
+  *decode_width = MAX (1, (int) ceil (width * factor));
+  *decode_height = MAX (1, (int) ceil (height * factor));
+}
+
+static gboolean
+file_cache_entry_fits (GfBG                 *bg,
+                       const FileCacheEntry *ent,
+                       int                   best_width,
+                       int                   best_height)
+{
+  int decode_width;
+  int decode_height;
+
+  if (ent->width == 0 || ent->height == 0)
+    return TRUE;
+
+  get_decode_size (bg->placement,
+                   ent->width,
+                   ent->height,
+                   best_width,
+                   best_height,
+                   &decode_width,
+                   &decode_height);
+
+  /* Allow a pixel of rounding difference from the loader */
+  return gdk_pixbuf_get_width (ent->u.pixbuf) + 1 >= decode_width &&
+         gdk_pixbuf_get_height (ent->u.pixbuf) + 1 >= decode_height;
+}
+
 static GdkPixbuf *
 get_as_pixbuf_for_size (GfBG       *bg,
                         const char *filename,
@@ -905,14 +1456,27 @@ get_as_pixbuf_for_size (GfBG       *bg,
                         gint        best_height)
 {
 	const FileCacheEntry *ent;
-	if ((ent = file_cache_lookup (bg, PIXBUF, filename))) {
+
+	ent = file_cache_lookup (bg, PIXBUF, filename);
+	if (ent && file_cache_entry_fits (bg, ent, best_width, best_height)) {
 		return g_object_ref (ent->u.pixbuf);
 	}
 	else {
 		GdkPixbufFormat *format;
 		GdkPixbuf *pixbuf;
                 gchar *tmp;
+		int width;
+		int height;
+		int decode_width;
+		int decode_height;
+
 		pixbuf = NULL;
+		width = 0;
+		height = 0;
+
+		/* A smaller image was decoded for another monitor */
+		if (ent)
+			file_cache_remove (bg, ent);
 
 		/* Try to hit local cache first if relevant */
 		if (num_monitor != -1)
@@ -920,7 +1484,7 @@ get_as_pixbuf_for_size (GfBG       *bg,
 
 		if (!pixbuf) {
 			/* If scalable choose maximum size */
-			format = gdk_pixbuf_get_file_info (filename, NULL, NULL);
+			format = gdk_pixbuf_get_file_info (filename, &width, &height);
 
 			if (format != NULL) {
 				tmp = gdk_pixbuf_format_get_name (format);
@@ -935,13 +1499,32 @@ get_as_pixbuf_for_size (GfBG       *bg,
 			     bg->placement == G_DESKTOP_BACKGROUND_STYLE_SCALED ||
 			     bg->placement == G_DESKTOP_BACKGROUND_STYLE_ZOOM))
 				pixbuf = gdk_pixbuf_new_from_file_at_size (filename, best_width, best_height, NULL);
-			else
+			else if (format != NULL && !gdk_pixbuf_format_is_scalable (format)) {
+				/* Let the loader decode at the final size, the
+				 * jpeg loader downscales while decoding */
+				get_decode_size (bg->placement, width, height,
+				                 best_width, best_height,
+				                 &decode_width, &decode_height);
+
+				if (decode_width < width || decode_height < height)
+					pixbuf = gdk_pixbuf_new_from_file_at_scale (filename,
+					                                            decode_width,
+					                                            decode_height,
+					                                            TRUE,
+					                                            NULL);
+			}
+
+			if (!pixbuf) {
 				pixbuf = gdk_pixbuf_new_from_file (filename, NULL);
+				width = 0;
+				height = 0;
+			}
+
 			g_free (tmp);
 		}
 
 		if (pixbuf)
-			file_cache_add_pixbuf (bg, filename, pixbuf);
+			file_cache_add_pixbuf (bg, filename, pixbuf, width, height);
 
 		return pixbuf;
 	}
@@ -1006,12 +1589,19 @@ blow_expensive_caches (gpointer data)
 		bg->pixbuf_cache = NULL;
 	}
 
+	transition_reset (bg->transition);
+
 	return FALSE;
 }
 
 static void
 blow_expensive_caches_in_idle (GfBG *bg)
 {
+	if (bg->snapshot) {
+		bg->snapshot_blow_caches = TRUE;
+		return;
+	}
+
 	if (bg->blow_caches_id == 0) {
 		bg->blow_caches_id =
 			g_idle_add (blow_expensive_caches,
@@ -1061,6 +1651,12 @@ static void
 ensure_timeout (GfBG    *bg,
                 gdouble  timeout)
 {
+	/* The timeout is added to the real background when rendering is done */
+	if (bg->snapshot) {
+		bg->snapshot_timeout = MIN (bg->snapshot_timeout, timeout);
+		return;
+	}
+
 	if (!bg->timeout_id) {
 		/* G_MAXUINT means "only one slide" */
 		if (timeout < G_MAXUINT) {
@@ -1110,6 +1706,10 @@ get_pixbuf_for_size (GfBG *bg,
 		width = gdk_pixbuf_get_width (bg->pixbuf_cache);
 		height = gdk_pixbuf_get_height (bg->pixbuf_cache);
 		hit_cache = 0.2 > fabs ((best_width / (double)best_height) - (width / (double)height));
+		/* Images may be decoded at the size of a smaller monitor */
+		hit_cache = hit_cache &&
+		            best_width <= bg->pixbuf_cache_width &&
+		            best_height <= bg->pixbuf_cache_height;
 		if (!hit_cache) {
 			g_object_unref (bg->pixbuf_cache);
 			bg->pixbuf_cache = NULL;
@@ -1118,6 +1718,8 @@ get_pixbuf_for_size (GfBG *bg,
 
 	if (!hit_cache && bg->filename) {
 		bg->file_mtime = get_mtime (bg->filename);
+		bg->pixbuf_cache_width = best_width;
+		bg->pixbuf_cache_height = best_height;
 
 		bg->pixbuf_cache = get_as_pixbuf_for_size (bg, bg->filename, num_monitor, best_width, best_height);
 		time_until_next_change = G_MAXUINT;
@@ -1151,7 +1753,7 @@ get_pixbuf_for_size (GfBG *bg,
 					p2 = get_as_pixbuf_for_size (bg, file2, num_monitor, best_width, best_height);
 
 					if (p1 && p2) {
-						bg->pixbuf_cache = blend (p1, p2, alpha);
+						bg->pixbuf_cache = transition_blend (bg->transition, p1, p2, alpha);
 					}
 					if (p1)
 						g_object_unref (p1);
@@ -1225,6 +1827,10 @@ clear_cache (GfBG *bg)
 		bg->pixbuf_cache = NULL;
 	}
 
+	/* Snapshots share the transition with the real background */
+	if (!bg->snapshot)
+		transition_reset (bg->transition);
+
 	if (bg->timeout_id) {
 		g_source_remove (bg->timeout_id);
 
@@ -1233,68 +1839,45 @@ clear_cache (GfBG *bg)
 }
 
 static void
-pixbuf_average_value (GdkPixbuf *pixbuf,
-                      GdkRGBA   *result)
-{
-	guint64 a_total, r_total, g_total, b_total;
-	guint row, column;
-	int row_stride;
-	const guchar *pixels, *p;
-	int r, g, b, a;
-	guint64 dividend;
-	guint width, height;
-	gdouble dd;
-	
-	width = gdk_pixbuf_get_width (pixbuf);
-	height = gdk_pixbuf_get_height (pixbuf);
-	row_stride = gdk_pixbuf_get_rowstride (pixbuf);
-	pixels = gdk_pixbuf_get_pixels (pixbuf);
-	
-	/* iterate through the pixbuf, counting up each component */
-	a_total = 0;
-	r_total = 0;
-	g_total = 0;
-	b_total = 0;
-	
-	if (gdk_pixbuf_get_has_alpha (pixbuf)) {
-		for (row = 0; row < height; row++) {
-			p = pixels + (row * row_stride);
-			for (column = 0; column < width; column++) {
-				r = *p++;
-				g = *p++;
-				b = *p++;
-				a = *p++;
-				
-				a_total += a;
-				r_total += (guint64) r * a;
-				g_total += (guint64) g * a;
-				b_total += (guint64) b * a;
-			}
-		}
-		dividend = (guint64) height * width * 0xFF;
-		a_total *= 0xFF;
-	} else {
-		for (row = 0; row < height; row++) {
-			p = pixels + (row * row_stride);
-			for (column = 0; column < width; column++) {
-				r = *p++;
-				g = *p++;
-				b = *p++;
-				
-				r_total += r;
-				g_total += g;
-				b_total += b;
-			}
-		}
-		dividend = (guint64) height * width;
-		a_total = dividend * 0xFF;
-	}
+surface_average_value (cairo_surface_t *surface,
+                       GdkRGBA         *result)
+{
+  const guchar *data;
+  int stride;
+  int width;
+  int height;
+  guint64 r_total;
+  guint64 g_total;
+  guint64 b_total;
+  double dividend;
+  int row;
+
+  cairo_surface_flush (surface);
+
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+
+  r_total = 0;
+  g_total = 0;
+  b_total = 0;
+
+  for (row = 0; row < height; row++)
+    {
+      gf_bg_sum_row_xrgb ((const guint32 *) (data + row * stride),
+                          width,
+                          &r_total,
+                          &g_total,
+                          &b_total);
+    }
 
-	dd = dividend * 0xFF;
-	result->alpha = a_total / dd;
-	result->red = r_total / dd;
-	result->green = g_total / dd;
-	result->blue = b_total / dd;
+  dividend = (double) width * height * 0xFF;
+
+  result->alpha = 1.0;
+  result->red = dividend > 0 ? r_total / dividend : 0;
+  result->green = dividend > 0 ? g_total / dividend : 0;
+  result->blue = dividend > 0 ? b_total / dividend : 0;
 }
 
 static GdkPixbuf *
@@ -1311,6 +1894,10 @@ pixbuf_scale_to_fit (GdkPixbuf *src, int max_width, int max_height)
 	
 	new_width  = floor (src_width * factor + 0.5);
 	new_height = floor (src_height * factor + 0.5);
+
+	/* Slides are usually decoded at the size they are drawn at */
+	if (new_width == src_width && new_height == src_height)
+		return g_object_ref (src);
 	
 	return gdk_pixbuf_scale_simple (src, new_width, new_height, GDK_INTERP_BILINEAR);	
 }
@@ -1326,6 +1913,9 @@ pixbuf_scale_to_min (GdkPixbuf *src, int min_width, int min_height)
 	src_width = gdk_pixbuf_get_width (src);
 	src_height = gdk_pixbuf_get_height (src);
 
+	if (src_width == min_width && src_height == min_height)
+		return g_object_ref (src);
+
 	factor = MAX (min_width / (double) src_width, min_height / (double) src_height);
 
 	new_width = floor (src_width * factor + 0.5);
@@ -1349,78 +1939,6 @@ pixbuf_scale_to_min (GdkPixbuf *src, int min_width, int min_height)
 	return dest;
 }
 
-static guchar *
-create_gradient (const GdkRGBA *primary,
-		 const GdkRGBA *secondary,
-		 int	        n_pixels)
-{
-	guchar *result = g_malloc (n_pixels * 3);
-	int i;
-	
-	for (i = 0; i < n_pixels; ++i) {
-		double ratio = (i + 0.5) / n_pixels;
-		
-		result[3 * i + 0] = (int) (0.5 + (primary->red * (1 - ratio) + secondary->red * ratio) * 255);
-		result[3 * i + 1] = (int) (0.5 + (primary->green * (1 - ratio) + secondary->green * ratio) * 255);
-		result[3 * i + 2] = (int) (0.5 + (primary->blue * (1 - ratio) + secondary->blue * ratio) * 255);
-	}
-	
-	return result;
-}	
-
-static void
-pixbuf_draw_gradient (GdkPixbuf    *pixbuf,
-		      gboolean      horizontal,
-		      GdkRGBA      *primary,
-		      GdkRGBA      *secondary,
-		      GdkRectangle *rect)
-{
-	int width;
-	int height;
-	int rowstride;
-	guchar *dst;
-	int n_channels = 3;
-
-	rowstride = gdk_pixbuf_get_rowstride (pixbuf);
-	width = rect->width;
-	height = rect->height;
-	dst = gdk_pixbuf_get_pixels (pixbuf) + rect->x * n_channels + rowstride * rect->y;
-
-	if (horizontal) {
-		guchar *gradient = create_gradient (primary, secondary, width);
-		int copy_bytes_per_row = width * n_channels;
-		int i;
-
-		for (i = 0; i < height; i++) {
-			guchar *d;
-			d = dst + rowstride * i;
-			memcpy (d, gradient, copy_bytes_per_row);
-		}
-		g_free (gradient);
-	} else {
-		guchar *gb, *gradient;
-		int i;
-
-		gradient = create_gradient (primary, secondary, height);
-		for (i = 0; i < height; i++) {
-			int j;
-			guchar *d;
-
-			d = dst + rowstride * i;
-			gb = gradient + n_channels * i;
-			for (j = width; j > 0; j--) {
-				int k;
-
-				for (k = 0; k < n_channels; k++) {
-					*(d++) = gb[k];
-				}
-			}
-		}
-
-		g_free (gradient);
-	}
-}
-
 static void
 pixbuf_blend (GdkPixbuf *src,
 	      GdkPixbuf *dest,
@@ -1457,6 +1975,39 @@ pixbuf_blend (GdkPixbuf *src,
 		src_height = dest_height - dest_y;
 	}
 
+	/* Opaque images fully inside the source are blended directly */
+	if (!gdk_pixbuf_get_has_alpha (src) &&
+	    !gdk_pixbuf_get_has_alpha (dest) &&
+	    src_width > 0 && src_height > 0 &&
+	    dest_x - offset_x >= 0 && dest_y - offset_y >= 0 &&
+	    dest_x - offset_x + src_width <= gdk_pixbuf_get_width (src) &&
+	    dest_y - offset_y + src_height <= gdk_pixbuf_get_height (src)) {
+		int src_stride = gdk_pixbuf_get_rowstride (src);
+		int dest_stride = gdk_pixbuf_get_rowstride (dest);
+		const guchar *s;
+		guchar *d;
+		guint a;
+		int i;
+
+		s = gdk_pixbuf_read_pixels (src) +
+		    (dest_y - offset_y) * src_stride + (dest_x - offset_x) * 3;
+		d = gdk_pixbuf_get_pixels (dest) +
+		    dest_y * dest_stride + dest_x * 3;
+		a = alpha * 0xFF + 0.5;
+
+		for (i = 0; i < src_height; i++) {
+			if (a >= 0xFF)
+				memcpy (d, s, src_width * 3);
+			else
+				gf_bg_blend_row (s, d, d, src_width * 3, a);
+
+			s += src_stride;
+			d += dest_stride;
+		}
+
+		return;
+	}
+
 	gdk_pixbuf_composite (src, dest,
 			      dest_x, dest_y,
 			      src_width, src_height,
@@ -1465,22 +2016,239 @@ pixbuf_blend (GdkPixbuf *src,
 			      alpha * 0xFF + 0.5);
 }
 
+/* Pixbuf rows go straight into the final surface, opaque images are
+ * converted and images with alpha are composited over the color */
+static void
+blit_rows (GdkPixbuf       *src,
+           int              src_x,
+           int              src_y,
+           cairo_surface_t *dest,
+           int              dest_x,
+           int              dest_y,
+           int              width,
+           int              height)
+{
+  const guchar *s;
+  guchar *d;
+  int src_stride;
+  int dest_stride;
+  int n_channels;
+  gboolean has_alpha;
+  int i;
+
+  src_stride = gdk_pixbuf_get_rowstride (src);
+  dest_stride = cairo_image_surface_get_stride (dest);
+  n_channels = gdk_pixbuf_get_n_channels (src);
+  has_alpha = gdk_pixbuf_get_has_alpha (src);
+
+  s = gdk_pixbuf_read_pixels (src) + src_y * src_stride + src_x * n_channels;
+  d = cairo_image_surface_get_data (dest) + dest_y * dest_stride + dest_x * 4;
+
+  for (i = 0; i < height; i++)
+    {
+      if (has_alpha)
+        gf_bg_composite_row_rgba (s, (guint32 *) d, width);
+      else
+        gf_bg_convert_row_rgb (s, (guint32 *) d, width);
+
+      s += src_stride;
+      d += dest_stride;
+    }
+}
+
+static void
+surface_blit (GdkPixbuf       *src,
+              cairo_surface_t *dest,
+              int              dest_x,
+              int              dest_y)
+{
+  int src_x;
+  int src_y;
+  int width;
+  int height;
+
+  src_x = 0;
+  src_y = 0;
+  width = gdk_pixbuf_get_width (src);
+  height = gdk_pixbuf_get_height (src);
+
+  if (dest_x < 0)
+    {
+      src_x = -dest_x;
+      width += dest_x;
+      dest_x = 0;
+    }
+
+  if (dest_y < 0)
+    {
+      src_y = -dest_y;
+      height += dest_y;
+      dest_y = 0;
+    }
+
+  width = MIN (width, cairo_image_surface_get_width (dest) - dest_x);
+  height = MIN (height, cairo_image_surface_get_height (dest) - dest_y);
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  cairo_surface_flush (dest);
+  blit_rows (src, src_x, src_y, dest, dest_x, dest_y, width, height);
+  cairo_surface_mark_dirty (dest);
+}
+
+static void
+surface_tile (GdkPixbuf       *src,
+              cairo_surface_t *dest)
+{
+  int tile_width;
+  int tile_height;
+  int dest_width;
+  int dest_height;
+  int dest_stride;
+  guchar *d;
+  int x;
+  int y;
+
+  tile_width = gdk_pixbuf_get_width (src);
+  tile_height = gdk_pixbuf_get_height (src);
+  dest_width = cairo_image_surface_get_width (dest);
+  dest_height = cairo_image_surface_get_height (dest);
+  dest_stride = cairo_image_surface_get_stride (dest);
+
+  cairo_surface_flush (dest);
+  d = cairo_image_surface_get_data (dest);
+
+  if (gdk_pixbuf_get_has_alpha (src))
+    {
+      /* Every tile blends with a different part of the color */
+      for (y = 0; y < dest_height; y += tile_height)
+        {
+          for (x = 0; x < dest_width; x += tile_width)
+            {
+              blit_rows (src, 0, 0, dest, x, y,
+                         MIN (tile_width, dest_width - x),
+                         MIN (tile_height, dest_height - y));
+            }
+        }
+    }
+  else
+    {
+      /* Fill the first band, then copy it downwards */
+      for (y = 0; y < dest_height; y++)
+        {
+          guchar *row;
+
+          row = d + y * dest_stride;
+
+          if (y < tile_height)
+            {
+              blit_rows (src, 0, y, dest, 0, y, MIN (tile_width, dest_width), 1);
+              gf_bg_fill_row (row, row, tile_width * 4, dest_width * 4);
+            }
+          else
+            {
+              memcpy (row, row - tile_height * dest_stride, dest_width * 4);
+            }
+        }
+    }
+
+  cairo_surface_mark_dirty (dest);
+}
+
 static void
-pixbuf_tile (GdkPixbuf *src, GdkPixbuf *dest)
+transition_buffer_free (guchar   *pixels,
+                        gpointer  data)
 {
-	int x, y;
-	int tile_width, tile_height;
-	int dest_width = gdk_pixbuf_get_width (dest);
-	int dest_height = gdk_pixbuf_get_height (dest);
-	tile_width = gdk_pixbuf_get_width (src);
-	tile_height = gdk_pixbuf_get_height (src);
-	
-	for (y = 0; y < dest_height; y += tile_height) {
-		for (x = 0; x < dest_width; x += tile_width) {
-			pixbuf_blend (src, dest, 0, 0,
-				      tile_width, tile_height, x, y, 1.0);
-		}
+	Transition *transition = data;
+
+	g_mutex_lock (&transition->lock);
+
+	if (transition->buffer == pixels)
+		transition->buffer_in_use = FALSE;
+	else
+		g_free (pixels);
+
+	g_mutex_unlock (&transition->lock);
+
+	g_atomic_rc_box_release_full (transition, transition_free);
+}
+
+static GdkPixbuf *
+transition_blend (Transition *transition,
+                  GdkPixbuf  *p1,
+                  GdkPixbuf  *p2,
+                  double      alpha)
+{
+	int width = gdk_pixbuf_get_width (p1);
+	int height = gdk_pixbuf_get_height (p1);
+	const guchar *from, *to;
+	guchar *dest;
+	int from_stride, to_stride, dest_stride;
+	guint a;
+	int i;
+	GdkPixbuf *result;
+
+	if (gdk_pixbuf_get_has_alpha (p1) || gdk_pixbuf_get_has_alpha (p2))
+		return blend (p1, p2, alpha);
+
+	g_mutex_lock (&transition->lock);
+
+	if (transition->from != p1 || transition->to != p2) {
+		g_set_object (&transition->from, p1);
+		g_set_object (&transition->to, p2);
+		g_clear_object (&transition->to_scaled);
+	}
+
+	if (transition->to_scaled == NULL) {
+		if (gdk_pixbuf_get_width (p2) != width ||
+		    gdk_pixbuf_get_height (p2) != height)
+			transition->to_scaled = gdk_pixbuf_scale_simple (p2, width, height,
+			                                                 GDK_INTERP_BILINEAR);
+		else
+			transition->to_scaled = g_object_ref (p2);
 	}
+
+	if (transition->buffer != NULL &&
+	    (transition->buffer_in_use ||
+	     transition->buffer_width != width ||
+	     transition->buffer_height != height))
+		transition_drop_buffer (transition);
+
+	/* Rows are aligned the same way gdk_pixbuf_new () does it */
+	dest_stride = (width * 3 + 3) & ~3;
+
+	if (transition->buffer == NULL) {
+		transition->buffer = g_malloc ((gsize) dest_stride * height);
+		transition->buffer_width = width;
+		transition->buffer_height = height;
+	}
+
+	from = gdk_pixbuf_read_pixels (p1);
+	to = gdk_pixbuf_read_pixels (transition->to_scaled);
+	dest = transition->buffer;
+	from_stride = gdk_pixbuf_get_rowstride (p1);
+	to_stride = gdk_pixbuf_get_rowstride (transition->to_scaled);
+	a = alpha * 0xFF + 0.5;
+
+	for (i = 0; i < height; i++) {
+		gf_bg_blend_row (to + i * to_stride,
+		                 from + i * from_stride,
+		                 dest + i * dest_stride,
+		                 width * 3,
+		                 MIN (a, 0xFF));
+	}
+
+	transition->buffer_in_use = TRUE;
+	result = gdk_pixbuf_new_from_data (transition->buffer,
+	                                   GDK_COLORSPACE_RGB, FALSE, 8,
+	                                   width, height, dest_stride,
+	                                   transition_buffer_free,
+	                                   g_atomic_rc_box_acquire (transition));
+
+	g_mutex_unlock (&transition->lock);
+
+	return result;
 }
 
 static Pixmap
@@ -1647,11 +2415,13 @@ set_root_pixmap (GdkDisplay *display,
                                &bytes_after,
                                &prop);
 
+  /* A repainted slideshow frame sets the same pixmap again */
   if (result == Success &&
       actual_type == XA_PIXMAP &&
       actual_format == 32 &&
       n_items == 1 &&
-      prop != NULL)
+      prop != NULL &&
+      *(Pixmap *) prop != pixmap)
     {
       gdk_x11_display_error_trap_push (display);
 
@@ -1750,6 +2520,9 @@ gf_bg_constructed (GObject *object)
 
   G_OBJECT_CLASS (gf_bg_parent_class)->constructed (object);
 
+  if (self->schema_id == NULL)
+    return;
+
   self->settings = g_settings_new (self->schema_id);
   self->interface_settings = g_settings_new ("org.gnome.desktop.interface");
 
@@ -1824,6 +2597,7 @@ gf_bg_finalize (GObject *object)
     }
 
   g_clear_pointer (&self->filename, g_free);
+  g_atomic_rc_box_release_full (self->transition, transition_free);
 
   G_OBJECT_CLASS (gf_bg_parent_class)->finalize (object);
 }
@@ -1905,6 +2679,7 @@ gf_bg_class_init (GfBGClass *self_class)
 static void
 gf_bg_init (GfBG *self)
 {
+  self->transition = transition_new ();
 }
 
 GfBG *
@@ -2070,6 +2845,669 @@ gf_bg_set_rgba (GfBG                      *self,
     }
 }
 
+/* Part of a rendered background, positioned in logical pixels */
+typedef struct
+{
+  int              x;
+  int              y;
+  cairo_surface_t *image;
+
+  /* Slideshow frames give the image back to it when freed */
+  Transition      *transition;
+} RenderPiece;
+
+typedef struct
+{
+  char            *key;
+  GPtrArray       *pieces;
+  GdkRGBA          average;
+  gsize            n_bytes;
+} RenderCacheEntry;
+
+static GMutex render_cache_lock;
+static GList *render_cache;
+static gsize render_cache_bytes;
+static guint render_cache_expire_id;
+
+static void
+render_cache_entry_free (gpointer data)
+{
+  RenderCacheEntry *entry;
+
+  entry = data;
+
+  g_free (entry->key);
+  g_ptr_array_unref (entry->pieces);
+  g_free (entry);
+}
+
+static gboolean
+render_cache_expire_cb (gpointer user_data)
+{
+  g_mutex_lock (&render_cache_lock);
+  g_list_free_full (render_cache, render_cache_entry_free);
+  render_cache = NULL;
+  render_cache_bytes = 0;
+  g_mutex_unlock (&render_cache_lock);
+
+  render_cache_expire_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called from the main thread */
+static void
+render_cache_schedule_expire (void)
+{
+  if (render_cache_expire_id != 0)
+    g_source_remove (render_cache_expire_id);
+
+  render_cache_expire_id =
+    g_timeout_add_seconds (KEEP_EXPENSIVE_CACHE_SECS,
+                           render_cache_expire_cb,
+                           NULL);
+
+  g_source_set_name_by_id (render_cache_expire_id,
+                           "[gnome-flashback] render_cache_expire_cb");
+}
+
+static char *
+render_cache_key (GfBG         *self,
+                  int           width,
+                  int           height,
+                  gint          scale,
+                  GdkRectangle *monitors,
+                  int           n_monitors,
+                  gboolean      root)
+{
+  GString *key;
+  char *primary;
+  char *secondary;
+  int i;
+
+  primary = gdk_rgba_to_string (&self->primary);
+  secondary = gdk_rgba_to_string (&self->secondary);
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key,
+                          "%s\n%" G_GINT64_FORMAT ":%d:%d:%s:%s:%dx%d@%d:%d",
+                          self->filename != NULL ? self->filename : "",
+                          (gint64) get_mtime (self->filename),
+                          self->placement,
+                          self->color_type,
+                          primary,
+                          secondary,
+                          width,
+                          height,
+                          scale,
+                          root);
+
+  for (i = 0; i < n_monitors; i++)
+    {
+      g_string_append_printf (key,
+                              ":%d,%d,%dx%d",
+                              monitors[i].x,
+                              monitors[i].y,
+                              monitors[i].width,
+                              monitors[i].height);
+    }
+
+  g_free (primary);
+  g_free (secondary);
+
+  return g_string_free (key, FALSE);
+}
+
+static GPtrArray *
+render_cache_lookup (const char *key,
+                     GdkRGBA    *average)
+{
+  GPtrArray *pieces;
+  GList *l;
+
+  pieces = NULL;
+
+  g_mutex_lock (&render_cache_lock);
+
+  for (l = render_cache; l != NULL; l = l->next)
+    {
+      RenderCacheEntry *entry;
+
+      entry = l->data;
+
+      if (g_strcmp0 (entry->key, key) != 0)
+        continue;
+
+      render_cache = g_list_remove_link (render_cache, l);
+      render_cache = g_list_concat (l, render_cache);
+
+      pieces = g_ptr_array_ref (entry->pieces);
+      *average = entry->average;
+      break;
+    }
+
+  g_mutex_unlock (&render_cache_lock);
+
+  return pieces;
+}
+
+static void
+render_cache_insert (const char    *key,
+                     GPtrArray     *pieces,
+                     const GdkRGBA *average)
+{
+  RenderCacheEntry *entry;
+  guint i;
+
+  entry = g_new0 (RenderCacheEntry, 1);
+  entry->key = g_strdup (key);
+  entry->pieces = g_ptr_array_ref (pieces);
+  entry->average = *average;
+
+  for (i = 0; i < pieces->len; i++)
+    {
+      RenderPiece *piece;
+
+      piece = g_ptr_array_index (pieces, i);
+
+      entry->n_bytes += (gsize) cairo_image_surface_get_stride (piece->image) *
+                        cairo_image_surface_get_height (piece->image);
+    }
+
+  g_mutex_lock (&render_cache_lock);
+
+  render_cache = g_list_prepend (render_cache, entry);
+  render_cache_bytes += entry->n_bytes;
+
+  while (render_cache_bytes > RENDER_CACHE_MAX_BYTES &&
+         render_cache->next != NULL)
+    {
+      GList *last;
+      RenderCacheEntry *last_entry;
+
+      last = g_list_last (render_cache);
+      last_entry = last->data;
+
+      render_cache_bytes -= last_entry->n_bytes;
+      render_cache_entry_free (last_entry);
+      render_cache = g_list_delete_link (render_cache, last);
+    }
+
+  g_mutex_unlock (&render_cache_lock);
+}
+
+static void
+render_piece_free (gpointer data)
+{
+  RenderPiece *piece;
+
+  piece = data;
+
+  if (piece->transition != NULL)
+    {
+      transition_give_image (piece->transition, piece->image);
+      g_atomic_rc_box_release_full (piece->transition, transition_free);
+    }
+  else
+    {
+      cairo_surface_destroy (piece->image);
+    }
+
+  g_free (piece);
+}
+
+static gboolean
+is_slideshow (GfBG *self)
+{
+  return self->filename != NULL &&
+         file_cache_lookup (self, SLIDESHOW, self->filename) != NULL;
+}
+
+static RenderPiece *
+render_piece (GfBG         *self,
+              GdkRectangle *geometry,
+              gint          scale,
+              gint          num_monitor,
+              Transition   *transition,
+              GdkRGBA      *average)
+{
+  cairo_surface_t *image;
+  RenderPiece *piece;
+
+  image = NULL;
+
+  if (transition != NULL)
+    image = transition_take_image (transition,
+                                   geometry->width,
+                                   geometry->height);
+
+  /* Drawn in device pixels, the scale is applied when done */
+  if (image == NULL)
+    {
+      image = cairo_image_surface_create (CAIRO_FORMAT_RGB24,
+                                          geometry->width,
+                                          geometry->height);
+    }
+
+  gf_bg_draw (self, image, num_monitor);
+  surface_average_value (image, average);
+
+  cairo_surface_set_device_scale (image, scale, scale);
+
+  piece = g_new0 (RenderPiece, 1);
+  piece->x = geometry->x / scale;
+  piece->y = geometry->y / scale;
+  piece->image = image;
+
+  if (transition != NULL)
+    piece->transition = g_atomic_rc_box_acquire (transition);
+
+  return piece;
+}
+
+static GPtrArray *
+render_pieces (GfBG         *self,
+               int           width,
+               int           height,
+               gint          scale,
+               GdkRectangle *monitors,
+               int           n_monitors,
+               gboolean      root,
+               GdkRGBA      *average)
+{
+  char *key;
+  GPtrArray *pieces;
+  Transition *transition;
+
+  key = render_cache_key (self,
+                          width,
+                          height,
+                          scale,
+                          monitors,
+                          n_monitors,
+                          root);
+
+  pieces = render_cache_lookup (key, average);
+
+  if (pieces != NULL)
+    {
+      g_free (key);
+      return pieces;
+    }
+
+  pieces = g_ptr_array_new_with_free_func (render_piece_free);
+
+  /* Slideshow frames change without the key changing, they are not
+   * cached and reuse the images of the previous frame instead */
+  transition = is_slideshow (self) ? self->transition : NULL;
+
+  /* Monitors are rendered on their own, the space between them is
+   * never allocated */
+  if (root && self->placement != G_DESKTOP_BACKGROUND_STYLE_SPANNED)
+    {
+      double total;
+      int i;
+
+      total = 0;
+      *average = (GdkRGBA) { 0 };
+
+      for (i = 0; i < n_monitors; i++)
+        {
+          GdkRGBA piece_average;
+          double area;
+
+          g_ptr_array_add (pieces,
+                           render_piece (self,
+                                         &monitors[i],
+                                         scale,
+                                         i,
+                                         transition,
+                                         &piece_average));
+
+          area = (double) monitors[i].width * monitors[i].height;
+          total += area;
+
+          average->red += piece_average.red * area;
+          average->green += piece_average.green * area;
+          average->blue += piece_average.blue * area;
+          average->alpha += piece_average.alpha * area;
+        }
+
+      if (total > 0)
+        {
+          average->red /= total;
+          average->green /= total;
+          average->blue /= total;
+          average->alpha /= total;
+        }
+    }
+  else
+    {
+      GdkRectangle geometry;
+
+      geometry.x = 0;
+      geometry.y = 0;
+      geometry.width = scale * width;
+      geometry.height = scale * height;
+
+      g_ptr_array_add (pieces,
+                       render_piece (self,
+                                     &geometry,
+                                     scale,
+                                     -1,
+                                     transition,
+                                     average));
+    }
+
+  if (transition == NULL)
+    render_cache_insert (key, pieces, average);
+
+  g_free (key);
+
+  return pieces;
+}
+
+static gboolean
+pieces_cover (GPtrArray *pieces,
+              int        width,
+              int        height)
+{
+  cairo_rectangle_int_t target;
+  cairo_region_t *region;
+  gboolean covered;
+  guint i;
+
+  region = cairo_region_create ();
+
+  for (i = 0; i < pieces->len; i++)
+    {
+      RenderPiece *piece;
+      double x_scale;
+      double y_scale;
+      cairo_rectangle_int_t rect;
+
+      piece = g_ptr_array_index (pieces, i);
+      cairo_surface_get_device_scale (piece->image, &x_scale, &y_scale);
+
+      rect.x = piece->x;
+      rect.y = piece->y;
+      rect.width = cairo_image_surface_get_width (piece->image) / x_scale;
+      rect.height = cairo_image_surface_get_height (piece->image) / y_scale;
+
+      cairo_region_union_rectangle (region, &rect);
+    }
+
+  target.x = 0;
+  target.y = 0;
+  target.width = width;
+  target.height = height;
+
+  covered = cairo_region_contains_rectangle (region, &target) ==
+            CAIRO_REGION_OVERLAP_IN;
+
+  cairo_region_destroy (region);
+
+  return covered;
+}
+
+static void
+paint_pieces (cairo_t       *cr,
+              GPtrArray     *pieces,
+              int            width,
+              int            height,
+              const GdkRGBA *fill)
+{
+  guint i;
+
+  /* Areas between or outside of monitors */
+  if (!pieces_cover (pieces, width, height))
+    {
+      gdk_cairo_set_source_rgba (cr, fill);
+      cairo_paint (cr);
+    }
+
+  for (i = 0; i < pieces->len; i++)
+    {
+      RenderPiece *piece;
+
+      piece = g_ptr_array_index (pieces, i);
+
+      cairo_set_source_surface (cr, piece->image, piece->x, piece->y);
+      cairo_paint (cr);
+    }
+}
+
+static gboolean
+is_solid_color (GfBG *self)
+{
+  return self->filename == NULL &&
+         self->color_type == G_DESKTOP_BACKGROUND_SHADING_SOLID;
+}
+
+static cairo_surface_t *
+lookup_target_surface (Transition *transition,
+                       GdkWindow  *window,
+                       int         width,
+                       int         height,
+                       gint        scale,
+                       gboolean    root)
+{
+  cairo_surface_t *surface;
+
+  surface = NULL;
+
+  g_mutex_lock (&transition->lock);
+
+  if (transition->target != NULL &&
+      transition->target_width == width &&
+      transition->target_height == height &&
+      transition->target_scale == scale &&
+      transition->target_root == root)
+    surface = cairo_surface_reference (transition->target);
+
+  g_mutex_unlock (&transition->lock);
+
+  /* Another client setting the root background kills our pixmap */
+  if (surface != NULL && root &&
+      !is_valid_pixmap (gdk_window_get_display (window),
+                        cairo_xlib_surface_get_drawable (surface)))
+    {
+      transition_drop_target (transition);
+      g_clear_pointer (&surface, cairo_surface_destroy);
+    }
+
+  return surface;
+}
+
+static void
+store_target_surface (Transition      *transition,
+                      cairo_surface_t *surface,
+                      int              width,
+                      int              height,
+                      gint             scale,
+                      gboolean         root)
+{
+  g_mutex_lock (&transition->lock);
+
+  g_clear_pointer (&transition->target, cairo_surface_destroy);
+  transition->target = cairo_surface_reference (surface);
+  transition->target_width = width;
+  transition->target_height = height;
+  transition->target_scale = scale;
+  transition->target_root = root;
+
+  g_mutex_unlock (&transition->lock);
+}
+
+/* Slideshow frames pass their transition to repaint the surface of the
+ * previous frame, everything else gets a new one */
+static cairo_surface_t *
+create_target_surface (GdkWindow  *window,
+                       int         width,
+                       int         height,
+                       gboolean    root,
+                       Transition *transition)
+{
+  cairo_surface_t *surface;
+  gint scale;
+
+  scale = gdk_window_get_scale_factor (window);
+
+  if (transition != NULL)
+    {
+      surface = lookup_target_surface (transition,
+                                       window,
+                                       width,
+                                       height,
+                                       scale,
+                                       root);
+
+      if (surface != NULL)
+        return surface;
+    }
+
+  if (root)
+    {
+      surface = create_persistent_surface (gdk_window_get_display (window),
+                                           scale * width,
+                                           scale * height);
+
+      cairo_surface_set_device_scale (surface, scale, scale);
+    }
+  else
+    {
+      surface = gdk_window_create_similar_surface (window,
+                                                   CAIRO_CONTENT_COLOR,
+                                                   width,
+                                                   height);
+    }
+
+  if (surface != NULL && transition != NULL)
+    store_target_surface (transition, surface, width, height, scale, root);
+
+  return surface;
+}
+
+static void
+copy_file_cache (GfBG *from,
+                 GfBG *to)
+{
+  GList *l;
+
+  for (l = g_list_last (from->file_cache); l != NULL; l = l->prev)
+    {
+      FileCacheEntry *ent;
+
+      ent = l->data;
+
+      if (file_cache_lookup (to, ent->type, ent->filename) != NULL)
+        continue;
+
+      if (ent->type == PIXBUF)
+        {
+          file_cache_add_pixbuf (to,
+                                 ent->filename,
+                                 ent->u.pixbuf,
+                                 ent->width,
+                                 ent->height);
+        }
+      else if (ent->type == SLIDESHOW)
+        {
+          file_cache_add_slide_show (to, ent->filename, ent->u.slideshow);
+        }
+    }
+}
+
+static GfBG *
+create_snapshot (GfBG *self)
+{
+  GfBG *snapshot;
+
+  snapshot = g_object_new (GF_TYPE_BG, NULL);
+  snapshot->snapshot = TRUE;
+  snapshot->snapshot_timeout = G_MAXDOUBLE;
+
+  snapshot->filename = g_strdup (self->filename);
+  snapshot->file_mtime = self->file_mtime;
+  snapshot->placement = self->placement;
+  snapshot->color_type = self->color_type;
+  snapshot->primary = self->primary;
+  snapshot->secondary = self->secondary;
+
+  /* Decoded images and parsed slideshows are immutable and can be shared
+   * with the worker */
+  copy_file_cache (self, snapshot);
+
+  g_atomic_rc_box_release_full (snapshot->transition, transition_free);
+  snapshot->transition = g_atomic_rc_box_acquire (self->transition);
+
+  return snapshot;
+}
+
+typedef struct
+{
+  GfBG            *snapshot;
+  GdkWindow       *window;
+  int              width;
+  int              height;
+  gint             scale;
+  gboolean         root;
+
+  GdkRectangle    *monitors;
+  int              n_monitors;
+
+  int              pm_width;
+  int              pm_height;
+  GPtrArray       *pieces;
+  GdkRGBA          average;
+} RenderData;
+
+static void
+render_data_free (gpointer data)
+{
+  RenderData *render;
+
+  render = data;
+
+  g_clear_object (&render->snapshot);
+  g_clear_object (&render->window);
+  g_free (render->monitors);
+  g_clear_pointer (&render->pieces, g_ptr_array_unref);
+
+  g_free (render);
+}
+
+static void
+render_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+  RenderData *render;
+
+  render = task_data;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  gf_bg_get_pixmap_size (render->snapshot,
+                         render->width,
+                         render->height,
+                         &render->pm_width,
+                         &render->pm_height);
+
+  render->pieces = render_pieces (render->snapshot,
+                                  render->width,
+                                  render->height,
+                                  render->scale,
+                                  render->monitors,
+                                  render->n_monitors,
+                                  render->root,
+                                  &render->average);
+
+  g_task_return_boolean (task, TRUE);
+}
+
 cairo_surface_t *
 gf_bg_create_surface (GfBG      *self,
                       GdkWindow *window,
@@ -2100,67 +3538,189 @@ gf_bg_create_surface (GfBG      *self,
   /* has the side effect of loading and caching pixbuf only when in tile mode */
   gf_bg_get_pixmap_size (self, width, height, &pm_width, &pm_height);
 
-  if (root)
+  if (is_solid_color (self))
     {
-      surface = create_persistent_surface (gdk_window_get_display (window),
-                                           scale * pm_width,
-                                           scale * pm_height);
+      surface = create_target_surface (window,
+                                       pm_width,
+                                       pm_height,
+                                       root,
+                                       NULL);
 
-      cairo_surface_set_device_scale (surface, scale, scale);
+      if (surface == NULL)
+        return NULL;
+
+      cr = cairo_create (surface);
+      gdk_cairo_set_source_rgba (cr, &self->primary);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+
+      average = self->primary;
     }
   else
     {
-      surface = gdk_window_create_similar_surface (window,
-                                                   CAIRO_CONTENT_COLOR,
-                                                   pm_width,
-                                                   pm_height);
+      GdkRectangle *monitors;
+      int n_monitors;
+      GPtrArray *pieces;
+
+      monitors = get_monitor_geometries (gdk_window_get_display (window),
+                                         scale,
+                                         &n_monitors);
+
+      pieces = render_pieces (self,
+                              width,
+                              height,
+                              scale,
+                              monitors,
+                              n_monitors,
+                              root,
+                              &average);
+
+      g_free (monitors);
+
+      surface = create_target_surface (window,
+                                       pm_width,
+                                       pm_height,
+                                       root,
+                                       is_slideshow (self) ?
+                                       self->transition : NULL);
+
+      if (surface != NULL)
+        {
+          cr = cairo_create (surface);
+          paint_pieces (cr, pieces, pm_width, pm_height, &self->primary);
+          cairo_destroy (cr);
+        }
+
+      g_ptr_array_unref (pieces);
+
+      if (surface == NULL)
+        return NULL;
+
+      render_cache_schedule_expire ();
     }
 
-  if (surface == NULL)
-    return NULL;
+  cairo_surface_set_user_data (surface,
+                               &average_color_key,
+                               gdk_rgba_copy (&average),
+                               (cairo_destroy_func_t) gdk_rgba_free);
 
-  cr = cairo_create (surface);
+  return surface;
+}
+
+void
+gf_bg_create_surface_async (GfBG                *self,
+                            GdkWindow           *window,
+                            int                  width,
+                            int                  height,
+                            gboolean             root,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  GTask *task;
+  RenderData *render;
+
+  g_return_if_fail (GF_IS_BG (self));
+  g_return_if_fail (window != NULL);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gf_bg_create_surface_async);
+
+  render = g_new0 (RenderData, 1);
+  render->snapshot = create_snapshot (self);
+  render->window = g_object_ref (window);
+  render->width = width;
+  render->height = height;
+  render->scale = gdk_window_get_scale_factor (window);
+  render->root = root;
+  render->pm_width = width;
+  render->pm_height = height;
+
+  g_task_set_task_data (task, render, render_data_free);
 
-  if (self->filename == NULL &&
-      self->color_type == G_DESKTOP_BACKGROUND_SHADING_SOLID)
+  /* Nothing to decode, the color is painted when finishing */
+  if (is_solid_color (self))
     {
-      gdk_cairo_set_source_rgba (cr, &self->primary);
-      average = self->primary;
+      render->average = self->primary;
+
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
     }
-  else
-    {
-      GdkPixbuf *pixbuf;
-      cairo_surface_t *pixbuf_surface;
 
-      pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
-                               FALSE,
-                               8,
-                               scale * width,
-                               scale * height);
+  render->monitors = get_monitor_geometries (gdk_window_get_display (window),
+                                             render->scale,
+                                             &render->n_monitors);
+
+  g_task_run_in_thread (task, render_thread);
+  g_object_unref (task);
+}
+
+cairo_surface_t *
+gf_bg_create_surface_finish (GfBG          *self,
+                             GAsyncResult  *result,
+                             GError       **error)
+{
+  RenderData *render;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
 
-      gf_bg_draw_at_scale (self,
-                           pixbuf,
-                           scale,
-                           gdk_window_get_display (window),
-                           root);
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return NULL;
 
-      pixbuf_average_value (pixbuf, &average);
+  render = g_task_get_task_data (G_TASK (result));
 
-      pixbuf_surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, 0, window);
-      cairo_set_source_surface (cr, pixbuf_surface, 0, 0);
+  /* Painting into a window-similar surface or pixmap is the upload to
+   * the X server, the rendered pieces stay shared with the cache */
+  surface = create_target_surface (render->window,
+                                   render->pm_width,
+                                   render->pm_height,
+                                   render->root,
+                                   is_slideshow (render->snapshot) ?
+                                   render->snapshot->transition : NULL);
 
-      cairo_surface_destroy (pixbuf_surface);
-      g_object_unref (pixbuf);
+  if (surface == NULL)
+    return NULL;
+
+  cr = cairo_create (surface);
+
+  if (render->pieces != NULL)
+    {
+      paint_pieces (cr,
+                    render->pieces,
+                    render->pm_width,
+                    render->pm_height,
+                    &render->snapshot->primary);
+      render_cache_schedule_expire ();
+    }
+  else
+    {
+      gdk_cairo_set_source_rgba (cr, &render->average);
+      cairo_paint (cr);
     }
 
-  cairo_paint (cr);
   cairo_destroy (cr);
 
   cairo_surface_set_user_data (surface,
                                &average_color_key,
-                               gdk_rgba_copy (&average),
+                               gdk_rgba_copy (&render->average),
                                (cairo_destroy_func_t) gdk_rgba_free);
 
+  /* Keep what the worker decoded if the background did not change */
+  if (g_strcmp0 (self->filename, render->snapshot->filename) == 0 &&
+      self->file_mtime == render->snapshot->file_mtime)
+    {
+      copy_file_cache (render->snapshot, self);
+
+      if (render->snapshot->snapshot_timeout != G_MAXDOUBLE)
+        ensure_timeout (self, render->snapshot->snapshot_timeout);
+
+      if (render->snapshot->snapshot_blow_caches)
+        blow_expensive_caches_in_idle (self);
+    }
+
   return surface;
 }
 
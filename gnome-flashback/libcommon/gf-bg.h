@@ -54,6 +54,19 @@ cairo_surface_t *gf_bg_create_surface                 (GfBG
                                                        int                        height,
                                                        gboolean                   root);
 
+void             gf_bg_create_surface_async           (GfBG                      *self,
+                                                       GdkWindow                 *window,
+                                                       int                        width,
+                                                       int                        height,
+                                                       gboolean                   root,
+                                                       GCancellable              *cancellable,
+                                                       GAsyncReadyCallback        callback,
+                                                       gpointer                   user_data);
+
+cairo_surface_t *gf_bg_create_surface_finish          (GfBG                      *self,
+                                                       GAsyncResult              *result,
+                                                       GError                   **error);
+
 void             gf_bg_set_surface_as_root            (GdkDisplay                *display,
                                                        cairo_surface_t           *surface);
 
@@ -26,12 +26,22 @@ typedef struct
   cairo_surface_t *start;
   cairo_surface_t *end;
 
-  double           start_time;
+  /* Current step, so redraws between steps paint a single surface */
+  cairo_surface_t *frame;
+  int              width;
+  int              height;
+
+  /* Frame clock times in microseconds, start is taken on the first tick */
+  gint64           start_time;
+  gint64           last_frame_time;
   double           total_duration;
-  gboolean         is_first_frame;
   double           percent_done;
 
-  guint            timeout_id;
+  guint            n_frames;
+  guint            n_dropped;
+
+  GtkWidget       *widget;
+  guint            tick_id;
 } FadeData;
 
 struct _GfBackground
@@ -46,6 +56,9 @@ struct _GfBackground
 
   guint            change_id;
 
+  GCancellable    *cancellable;
+  gboolean         fade;
+
   FadeData        *fade_data;
   cairo_surface_t *surface;
 };
@@ -76,49 +89,108 @@ G_DEFINE_TYPE (GfBackground, gf_background, G_TYPE_OBJECT)
 static void
 free_fade_data (FadeData *data)
 {
-  if (data->timeout_id != 0)
+  /* The tick callback went away with the widget if it was destroyed */
+  if (data->widget != NULL)
     {
-      g_source_remove (data->timeout_id);
-      data->timeout_id = 0;
+      if (data->tick_id != 0)
+        gtk_widget_remove_tick_callback (data->widget, data->tick_id);
+
+      g_object_remove_weak_pointer (G_OBJECT (data->widget),
+                                    (gpointer *) &data->widget);
     }
 
+  data->tick_id = 0;
+
   g_clear_pointer (&data->start, cairo_surface_destroy);
   g_clear_pointer (&data->end, cairo_surface_destroy);
+  g_clear_pointer (&data->frame, cairo_surface_destroy);
   g_free (data);
 }
 
+static void
+update_fade_frame (FadeData *fade)
+{
+  cairo_t *cr;
+
+  if (fade->frame == NULL)
+    {
+      fade->frame = cairo_surface_create_similar (fade->end,
+                                                  CAIRO_CONTENT_COLOR,
+                                                  fade->width,
+                                                  fade->height);
+    }
+
+  cr = cairo_create (fade->frame);
+
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface (cr, fade->start, 0, 0);
+  cairo_paint (cr);
+
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  cairo_set_source_surface (cr, fade->end, 0, 0);
+  cairo_paint_with_alpha (cr, fade->percent_done);
+
+  cairo_destroy (cr);
+}
+
 static gboolean
-fade_cb (gpointer user_data)
+fade_tick_cb (GtkWidget     *widget,
+              GdkFrameClock *frame_clock,
+              gpointer       user_data)
 {
   GfBackground *self;
   FadeData *fade;
-  double current_time;
+  gint64 frame_time;
+  gint64 refresh_interval;
+  gint64 missed;
   double percent_done;
 
   self = GF_BACKGROUND (user_data);
   fade = self->fade_data;
 
-  current_time = g_get_real_time () / (double) G_USEC_PER_SEC;
-  percent_done = (current_time - fade->start_time) / fade->total_duration;
-  percent_done = CLAMP (percent_done, 0.0, 1.0);
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
 
-  if (fade->is_first_frame && percent_done > 0.33)
+  if (fade->n_frames == 0)
     {
-      fade->total_duration *= 1.5;
-      fade->is_first_frame = FALSE;
+      fade->start_time = frame_time;
+    }
+  else
+    {
+      gdk_frame_clock_get_refresh_info (frame_clock, frame_time,
+                                        &refresh_interval, NULL);
+
+      if (refresh_interval <= 0)
+        refresh_interval = G_USEC_PER_SEC / 60;
 
-      return fade_cb (self);
+      /* Late frames are not drawn twice, progress jumps ahead instead */
+      missed = (frame_time - fade->last_frame_time + refresh_interval / 2) /
+               refresh_interval - 1;
+
+      if (missed > 0)
+        fade->n_dropped += missed;
     }
 
-  gtk_widget_queue_draw (self->window);
+  fade->last_frame_time = frame_time;
+  fade->n_frames++;
+
+  percent_done = (frame_time - fade->start_time) /
+                 (fade->total_duration * G_USEC_PER_SEC);
+  percent_done = CLAMP (percent_done, 0.0, 1.0);
 
-  fade->is_first_frame = FALSE;
   fade->percent_done = percent_done;
 
+  gtk_widget_queue_draw (self->window);
+
   if (percent_done < 0.99)
-    return G_SOURCE_CONTINUE;
+    {
+      update_fade_frame (fade);
+      return G_SOURCE_CONTINUE;
+    }
 
-  self->fade_data->timeout_id = 0;
+  g_debug ("Background fade finished: %u frames, %u dropped",
+           fade->n_frames, fade->n_dropped);
+
+  fade->tick_id = 0;
 
   g_clear_pointer (&self->surface, cairo_surface_destroy);
   self->surface = cairo_surface_reference (fade->end);
@@ -134,25 +206,44 @@ fade_cb (gpointer user_data)
 }
 
 static void
-change (GfBackground *self,
-        gboolean      fade)
+create_surface_cb (GObject      *object,
+                   GAsyncResult *res,
+                   gpointer      user_data)
 {
+  cairo_surface_t *surface;
+  GError *error;
+  GfBackground *self;
   GdkDisplay *display;
-  GdkScreen *screen;
-  GdkWindow *root;
   int width;
   int height;
 
+  error = NULL;
+  surface = gf_bg_create_surface_finish (GF_BG (object), res, &error);
+
+  if (error != NULL)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Error creating background surface: %s", error->message);
+
+      g_error_free (error);
+      return;
+    }
+
+  self = GF_BACKGROUND (user_data);
+  g_clear_object (&self->cancellable);
+
+  if (surface == NULL)
+    return;
+
   display = gtk_widget_get_display (self->window);
-  screen = gtk_widget_get_screen (self->window);
-  root = gdk_screen_get_root_window (screen);
 
   width = gf_desktop_window_get_width (GF_DESKTOP_WINDOW (self->window));
   height = gf_desktop_window_get_height (GF_DESKTOP_WINDOW (self->window));
 
   g_clear_pointer (&self->fade_data, free_fade_data);
 
-  if (fade)
+  /* The frame clock only ticks for a mapped window */
+  if (self->fade && gtk_widget_get_mapped (self->window))
     {
       FadeData *data;
 
@@ -164,23 +255,26 @@ change (GfBackground *self,
       else
         data->start = gf_bg_get_surface_from_root (display, width, height);
 
-      data->end = gf_bg_create_surface (self->bg, root, width, height, TRUE);
+      data->end = surface;
+      data->width = width;
+      data->height = height;
 
-      data->start_time = g_get_real_time () / (double) G_USEC_PER_SEC;
       data->total_duration = .75;
-      data->is_first_frame = TRUE;
       data->percent_done = .0;
 
-      data->timeout_id = g_timeout_add (1000 / 60.0, fade_cb, self);
+      data->widget = self->window;
+      g_object_add_weak_pointer (G_OBJECT (data->widget),
+                                 (gpointer *) &data->widget);
+
+      data->tick_id = gtk_widget_add_tick_callback (self->window,
+                                                    fade_tick_cb,
+                                                    self,
+                                                    NULL);
     }
   else
     {
       g_clear_pointer (&self->surface, cairo_surface_destroy);
-      self->surface = gf_bg_create_surface (self->bg,
-                                            root,
-                                            width,
-                                            height,
-                                            TRUE);
+      self->surface = surface;
 
       gf_bg_set_surface_as_root (display, self->surface);
 
@@ -191,6 +285,37 @@ change (GfBackground *self,
   gtk_widget_queue_draw (self->window);
 }
 
+static void
+change (GfBackground *self,
+        gboolean      fade)
+{
+  GdkScreen *screen;
+  GdkWindow *root;
+  int width;
+  int height;
+
+  screen = gtk_widget_get_screen (self->window);
+  root = gdk_screen_get_root_window (screen);
+
+  width = gf_desktop_window_get_width (GF_DESKTOP_WINDOW (self->window));
+  height = gf_desktop_window_get_height (GF_DESKTOP_WINDOW (self->window));
+
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
+  self->cancellable = g_cancellable_new ();
+  self->fade = fade;
+
+  gf_bg_create_surface_async (self->bg,
+                              root,
+                              width,
+                              height,
+                              TRUE,
+                              self->cancellable,
+                              create_surface_cb,
+                              self);
+}
+
 typedef struct
 {
   GfBackground *background;
@@ -235,20 +360,34 @@ draw_cb (GtkWidget    *widget,
          cairo_t      *cr,
          GfBackground *self)
 {
+  GdkRectangle clip;
+  cairo_surface_t *surface;
+
   if (self->fade_data != NULL)
     {
-      cairo_set_source_surface (cr, self->fade_data->start, 0, 0);
-      cairo_paint (cr);
+      surface = self->fade_data->frame;
 
-      cairo_set_source_surface (cr, self->fade_data->end, 0, 0);
-      cairo_paint_with_alpha (cr, self->fade_data->percent_done);
+      if (surface == NULL)
+        surface = self->fade_data->start;
     }
-  else if (self->surface != NULL)
+  else
     {
-      cairo_set_source_surface (cr, self->surface, 0, 0);
-      cairo_paint (cr);
+      surface = self->surface;
     }
 
+  /* Only the damaged area is painted, the background is opaque */
+  if (surface == NULL || !gdk_cairo_get_clip_rectangle (cr, &clip))
+    return FALSE;
+
+  cairo_save (cr);
+
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  gdk_cairo_rectangle (cr, &clip);
+  cairo_fill (cr);
+
+  cairo_restore (cr);
+
   return FALSE;
 }
 
@@ -315,9 +454,14 @@ gf_background_dispose (GObject *object)
 
   self = GF_BACKGROUND (object);
 
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
   g_clear_object (&self->settings2);
   g_clear_object (&self->bg);
 
+  g_clear_pointer (&self->fade_data, free_fade_data);
+
   G_OBJECT_CLASS (gf_background_parent_class)->dispose (object);
 }
 
@@ -334,7 +478,6 @@ gf_background_finalize (GObject *object)
       self->change_id = 0;
     }
 
-  g_clear_pointer (&self->fade_data, free_fade_data);
   g_clear_pointer (&self->surface, cairo_surface_destroy);
 
   G_OBJECT_CLASS (gf_background_parent_class)->finalize (object);
@@ -419,26 +419,46 @@ move_resize (GfDesktopWindow *self)
 {
   GtkWidget *widget;
   GdkRectangle rect;
-  GdkDisplay *display;
-  int n_monitors;
-  int i;
   GdkScreen *screen;
 
   widget = GTK_WIDGET (self);
 
   rect = (GdkRectangle) {};
-  display = gdk_display_get_default ();
-  n_monitors = gdk_display_get_n_monitors (display);
 
-  for (i = 0; i < n_monitors; i++)
+  /* GDK reads monitors on its own X connection and may not have seen
+   * the change reported by the monitor manager yet */
+  if (self->monitor_manager != NULL)
     {
-      GdkMonitor *monitor;
-      GdkRectangle geometry;
+      int scale;
 
-      monitor = gdk_display_get_monitor (display, i);
+      scale = gtk_widget_get_scale_factor (widget);
+
+      gf_monitor_manager_get_screen_size (self->monitor_manager,
+                                          &rect.width,
+                                          &rect.height);
+
+      rect.width /= scale;
+      rect.height /= scale;
+    }
+  else
+    {
+      GdkDisplay *display;
+      int n_monitors;
+      int i;
+
+      display = gdk_display_get_default ();
+      n_monitors = gdk_display_get_n_monitors (display);
+
+      for (i = 0; i < n_monitors; i++)
+        {
+          GdkMonitor *monitor;
+          GdkRectangle geometry;
+
+          monitor = gdk_display_get_monitor (display, i);
 
-      gdk_monitor_get_geometry (monitor, &geometry);
-      gdk_rectangle_union (&rect, &geometry, &rect);
+          gdk_monitor_get_geometry (monitor, &geometry);
+          gdk_rectangle_union (&rect, &geometry, &rect);
+        }
     }
 
   if (rect.width < 640)
@@ -524,6 +544,17 @@ monitor_removed_cb (GdkDisplay      *display,
   queue_move_resize (self);
 }
 
+static void
+monitor_changes_cb (GfMonitorManager        *monitor_manager,
+                    const GfMonitorsChanges *changes,
+                    GfDesktopWindow         *self)
+{
+  if (gf_monitors_changes_is_empty (changes))
+    return;
+
+  queue_move_resize (self);
+}
+
 static gboolean
 gf_desktop_window_initable_init (GInitable     *initable,
                                  GCancellable  *cancellable,
@@ -838,7 +869,37 @@ void
 gf_desktop_window_set_monitor_manager (GfDesktopWindow  *self,
                                        GfMonitorManager *monitor_manager)
 {
+  GdkDisplay *display;
+  int n_monitors;
+  int i;
+
+  if (self->monitor_manager == monitor_manager)
+    return;
+
+  g_assert (self->monitor_manager == NULL);
   self->monitor_manager = monitor_manager;
+
+  /* Only real layout changes are reported by the monitor manager */
+  display = gdk_display_get_default ();
+  n_monitors = gdk_display_get_n_monitors (display);
+
+  g_signal_handlers_disconnect_by_func (display, monitor_added_cb, self);
+  g_signal_handlers_disconnect_by_func (display, monitor_removed_cb, self);
+
+  for (i = 0; i < n_monitors; i++)
+    {
+      GdkMonitor *monitor;
+
+      monitor = gdk_display_get_monitor (display, i);
+
+      g_signal_handlers_disconnect_by_func (monitor, notify_geometry_cb, self);
+    }
+
+  g_signal_connect_object (monitor_manager, "monitor-changes",
+                           G_CALLBACK (monitor_changes_cb),
+                           self, 0);
+
+  queue_move_resize (self);
 }
 
 gboolean
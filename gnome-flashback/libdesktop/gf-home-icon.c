@@ -22,11 +22,85 @@
 
 struct _GfHomeIcon
 {
-  GfIcon parent;
+  GfIcon        parent;
+
+  GFileMonitor *monitor;
 };
 
 G_DEFINE_TYPE (GfHomeIcon, gf_home_icon, GF_TYPE_ICON)
 
+static void
+home_changed_cb (GFileMonitor      *monitor,
+                 GFile             *file,
+                 GFile             *other_file,
+                 GFileMonitorEvent  event_type,
+                 GfHomeIcon        *self)
+{
+  switch (event_type)
+    {
+      case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+        gf_icon_update (GF_ICON (self));
+        break;
+
+      case G_FILE_MONITOR_EVENT_CHANGED:
+      case G_FILE_MONITOR_EVENT_DELETED:
+      case G_FILE_MONITOR_EVENT_CREATED:
+      case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
+      case G_FILE_MONITOR_EVENT_UNMOUNTED:
+      case G_FILE_MONITOR_EVENT_MOVED:
+      case G_FILE_MONITOR_EVENT_RENAMED:
+      case G_FILE_MONITOR_EVENT_MOVED_IN:
+      case G_FILE_MONITOR_EVENT_MOVED_OUT:
+      default:
+        break;
+    }
+}
+
+static void
+gf_home_icon_dispose (GObject *object)
+{
+  GfHomeIcon *self;
+
+  self = GF_HOME_ICON (object);
+
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (gf_home_icon_parent_class)->dispose (object);
+}
+
+/* The home directory is not a child of the desktop directory, so its
+ * own changes are not seen by the desktop directory monitor.
+ */
+static void
+gf_home_icon_create_file_monitor (GfIcon *icon)
+{
+  GfHomeIcon *self;
+  GError *error;
+
+  self = GF_HOME_ICON (icon);
+
+  g_clear_object (&self->monitor);
+
+  error = NULL;
+  self->monitor = g_file_monitor_file (gf_icon_get_file (icon),
+                                       G_FILE_MONITOR_NONE,
+                                       NULL,
+                                       &error);
+
+  if (error != NULL)
+    {
+      g_warning ("%s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_signal_connect (self->monitor,
+                    "changed",
+                    G_CALLBACK (home_changed_cb),
+                    self);
+}
+
 static GIcon *
 gf_home_icon_get_icon (GfIcon   *icon,
                        gboolean *is_thumbnail)
@@ -60,10 +134,15 @@ gf_home_icon_can_rename (GfIcon *icon)
 static void
 gf_home_icon_class_init (GfHomeIconClass *self_class)
 {
+  GObjectClass *object_class;
   GfIconClass *icon_class;
 
+  object_class = G_OBJECT_CLASS (self_class);
   icon_class = GF_ICON_CLASS (self_class);
 
+  object_class->dispose = gf_home_icon_dispose;
+
+  icon_class->create_file_monitor = gf_home_icon_create_file_monitor;
   icon_class->get_icon = gf_home_icon_get_icon;
   icon_class->get_text = gf_home_icon_get_text;
   icon_class->can_delete = gf_home_icon_can_delete;
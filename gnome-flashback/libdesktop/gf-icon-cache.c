@@ -0,0 +1,614 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "gf-icon-cache.h"
+
+#include <errno.h>
+#include <locale.h>
+#include <string.h>
+
+#include "gf-icon.h"
+
+#define CACHE_MAGIC "GFIC"
+#define CACHE_VERSION 2
+#define CACHE_BYTE_ORDER 0x01020304
+
+#define ENTRY_FLAG_HIDDEN (1 << 0)
+#define ENTRY_FLAG_BACKUP (1 << 1)
+
+/* The cache file starts with a header followed by a table of fixed size
+ * entries and a table of NUL terminated strings. Strings are referenced
+ * by their offset from the start of the file, 0 is used for NULL.
+ */
+typedef struct
+{
+  char    magic[4];
+  guint32 version;
+  guint32 byte_order;
+  guint32 n_entries;
+  guint32 directory;
+  guint32 locale;
+} GfCacheHeader;
+
+typedef struct
+{
+  guint64 size;
+  guint64 time_modified;
+  guint32 file_type;
+  guint32 flags;
+  guint32 uri;
+  guint32 name;
+  guint32 display_name;
+  guint32 name_collated;
+  guint32 content_type;
+  guint32 icon;
+  guint32 thumbnail_path;
+  guint32 padding;
+} GfCacheEntry;
+
+struct _GfIconCache
+{
+  GObject  parent;
+
+  char    *directory;
+  char    *filename;
+  char    *locale;
+
+  gboolean saving;
+  GBytes  *pending_save;
+};
+
+G_DEFINE_TYPE (GfIconCache, gf_icon_cache, G_TYPE_OBJECT)
+
+static char *
+get_cache_filename (const char *directory)
+{
+  char *checksum;
+  char *basename;
+  char *filename;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, directory, -1);
+  basename = g_strdup_printf ("%s.cache", checksum);
+  g_free (checksum);
+
+  filename = g_build_filename (g_get_user_cache_dir (),
+                               "gnome-flashback",
+                               "desktop",
+                               basename,
+                               NULL);
+
+  g_free (basename);
+
+  return filename;
+}
+
+/* Collation keys and localized .desktop names depend on these */
+static char *
+get_cache_locale (void)
+{
+  return g_strdup_printf ("%s;%s",
+                          setlocale (LC_COLLATE, NULL),
+                          setlocale (LC_MESSAGES, NULL));
+}
+
+static gboolean
+get_string (const char  *data,
+            gsize        length,
+            guint32      offset,
+            const char **string)
+{
+  if (offset == 0)
+    {
+      *string = NULL;
+      return TRUE;
+    }
+
+  if (offset >= length || memchr (data + offset, '\0', length - offset) == NULL)
+    return FALSE;
+
+  *string = data + offset;
+
+  return TRUE;
+}
+
+static GFileInfo *
+create_file_info (const char         *data,
+                  gsize               length,
+                  const GfCacheEntry *entry,
+                  const char        **uri)
+{
+  const char *name;
+  const char *display_name;
+  const char *name_collated;
+  const char *content_type;
+  const char *icon_string;
+  const char *thumbnail_path;
+  GFileInfo *info;
+
+  if (!get_string (data, length, entry->uri, uri) ||
+      !get_string (data, length, entry->name, &name) ||
+      !get_string (data, length, entry->display_name, &display_name) ||
+      !get_string (data, length, entry->name_collated, &name_collated) ||
+      !get_string (data, length, entry->content_type, &content_type) ||
+      !get_string (data, length, entry->icon, &icon_string) ||
+      !get_string (data, length, entry->thumbnail_path, &thumbnail_path))
+    return NULL;
+
+  if (*uri == NULL || name == NULL)
+    return NULL;
+
+  info = g_file_info_new ();
+
+  g_file_info_set_name (info, name);
+  g_file_info_set_file_type (info, entry->file_type);
+  g_file_info_set_size (info, entry->size);
+
+  g_file_info_set_attribute_uint64 (info,
+                                    G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                    entry->time_modified);
+
+  g_file_info_set_attribute_boolean (info,
+                                     G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN,
+                                     entry->flags & ENTRY_FLAG_HIDDEN);
+
+  g_file_info_set_attribute_boolean (info,
+                                     G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP,
+                                     entry->flags & ENTRY_FLAG_BACKUP);
+
+  if (display_name != NULL)
+    g_file_info_set_display_name (info, display_name);
+
+  if (content_type != NULL)
+    g_file_info_set_content_type (info, content_type);
+
+  if (icon_string != NULL)
+    {
+      GIcon *icon;
+
+      icon = g_icon_new_for_string (icon_string, NULL);
+
+      if (icon != NULL)
+        {
+          g_file_info_set_icon (info, icon);
+          g_object_unref (icon);
+        }
+    }
+
+  if (name_collated != NULL)
+    {
+      g_file_info_set_attribute_string (info,
+                                        GF_ICON_ATTRIBUTE_NAME_COLLATED,
+                                        name_collated);
+    }
+
+  if (thumbnail_path != NULL)
+    {
+      g_file_info_set_attribute_byte_string (info,
+                                             GF_ICON_ATTRIBUTE_THUMBNAIL_PATH,
+                                             thumbnail_path);
+    }
+
+  return info;
+}
+
+static gboolean
+is_valid_header (GfIconCache         *self,
+                 const char          *data,
+                 gsize                length,
+                 const GfCacheHeader *header)
+{
+  const char *directory;
+  const char *locale;
+
+  if (length < sizeof (GfCacheHeader))
+    return FALSE;
+
+  if (memcmp (header->magic, CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+      header->version != CACHE_VERSION ||
+      header->byte_order != CACHE_BYTE_ORDER)
+    return FALSE;
+
+  if (header->n_entries > (length - sizeof (GfCacheHeader)) / sizeof (GfCacheEntry))
+    return FALSE;
+
+  if (!get_string (data, length, header->directory, &directory) ||
+      !get_string (data, length, header->locale, &locale))
+    return FALSE;
+
+  return g_strcmp0 (directory, self->directory) == 0 &&
+         g_strcmp0 (locale, self->locale) == 0;
+}
+
+static guint32
+append_string (GString    *strings,
+               gsize       strings_offset,
+               const char *string)
+{
+  guint32 offset;
+
+  if (string == NULL)
+    return 0;
+
+  offset = strings_offset + strings->len;
+  g_string_append_len (strings, string, strlen (string) + 1);
+
+  return offset;
+}
+
+static gboolean
+can_cache_icon (GfIcon *icon)
+{
+  GFileInfo *info;
+
+  /* Home and trash icons are always created */
+  if (G_OBJECT_TYPE (icon) != GF_TYPE_ICON)
+    return FALSE;
+
+  info = gf_icon_get_file_info (icon);
+
+  return g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_NAME) &&
+         g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+}
+
+static GBytes *
+serialize_icons (GfIconCache *self,
+                 GPtrArray   *icons)
+{
+  GPtrArray *cacheable;
+  gsize strings_offset;
+  GfCacheHeader header;
+  GArray *entries;
+  GString *strings;
+  GByteArray *bytes;
+  guint i;
+
+  cacheable = g_ptr_array_new ();
+
+  for (i = 0; i < icons->len; i++)
+    {
+      GfIcon *icon;
+
+      icon = g_ptr_array_index (icons, i);
+
+      if (can_cache_icon (icon))
+        g_ptr_array_add (cacheable, icon);
+    }
+
+  strings_offset = sizeof (GfCacheHeader) +
+                   cacheable->len * sizeof (GfCacheEntry);
+
+  entries = g_array_sized_new (FALSE, TRUE, sizeof (GfCacheEntry),
+                               cacheable->len);
+
+  strings = g_string_new (NULL);
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, CACHE_MAGIC, sizeof (header.magic));
+  header.version = CACHE_VERSION;
+  header.byte_order = CACHE_BYTE_ORDER;
+  header.n_entries = cacheable->len;
+  header.directory = append_string (strings, strings_offset, self->directory);
+  header.locale = append_string (strings, strings_offset, self->locale);
+
+  for (i = 0; i < cacheable->len; i++)
+    {
+      GfIcon *icon;
+      GFileInfo *info;
+      GfCacheEntry entry;
+      char *uri;
+      GIcon *gicon;
+      char *icon_string;
+      GFile *thumbnail;
+      char *thumbnail_path;
+
+      icon = g_ptr_array_index (cacheable, i);
+      info = gf_icon_get_file_info (icon);
+
+      memset (&entry, 0, sizeof (entry));
+
+      entry.size = gf_icon_get_size (icon);
+      entry.time_modified = gf_icon_get_time_modified (icon);
+      entry.file_type = gf_icon_get_file_type (icon);
+
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN))
+        entry.flags |= ENTRY_FLAG_HIDDEN;
+
+      if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP))
+        entry.flags |= ENTRY_FLAG_BACKUP;
+
+      uri = g_file_get_uri (gf_icon_get_file (icon));
+      entry.uri = append_string (strings, strings_offset, uri);
+      g_free (uri);
+
+      entry.name = append_string (strings,
+                                  strings_offset,
+                                  g_file_info_get_name (info));
+
+      if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME))
+        {
+          entry.display_name = append_string (strings,
+                                              strings_offset,
+                                              g_file_info_get_display_name (info));
+        }
+
+      entry.name_collated = append_string (strings,
+                                           strings_offset,
+                                           gf_icon_get_name_collated (icon));
+
+      if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
+        {
+          entry.content_type = append_string (strings,
+                                              strings_offset,
+                                              g_file_info_get_content_type (info));
+        }
+
+      icon_string = NULL;
+      if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ICON))
+        {
+          gicon = g_file_info_get_icon (info);
+
+          if (gicon != NULL)
+            icon_string = g_icon_to_string (gicon);
+        }
+
+      entry.icon = append_string (strings, strings_offset, icon_string);
+      g_free (icon_string);
+
+      thumbnail = gf_icon_get_thumbnail (icon);
+      thumbnail_path = thumbnail != NULL ? g_file_get_path (thumbnail) : NULL;
+
+      entry.thumbnail_path = append_string (strings,
+                                            strings_offset,
+                                            thumbnail_path);
+      g_free (thumbnail_path);
+
+      g_array_append_val (entries, entry);
+    }
+
+  bytes = g_byte_array_sized_new (strings_offset + strings->len);
+
+  g_byte_array_append (bytes, (guint8 *) &header, sizeof (header));
+  g_byte_array_append (bytes,
+                       (guint8 *) entries->data,
+                       entries->len * sizeof (GfCacheEntry));
+  g_byte_array_append (bytes, (guint8 *) strings->str, strings->len);
+
+  g_ptr_array_free (cacheable, TRUE);
+  g_array_free (entries, TRUE);
+  g_string_free (strings, TRUE);
+
+  return g_byte_array_free_to_bytes (bytes);
+}
+
+static void
+save_in_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  GfIconCache *self;
+  GBytes *bytes;
+  char *dirname;
+  GError *error;
+  gconstpointer data;
+  gsize length;
+
+  self = GF_ICON_CACHE (source_object);
+  bytes = task_data;
+
+  dirname = g_path_get_dirname (self->filename);
+
+  if (g_mkdir_with_parents (dirname, 0700) != 0)
+    {
+      g_task_return_new_error (task,
+                               G_IO_ERROR,
+                               g_io_error_from_errno (errno),
+                               "Failed to create directory “%s”: %s",
+                               dirname,
+                               g_strerror (errno));
+
+      g_free (dirname);
+      return;
+    }
+
+  g_free (dirname);
+
+  error = NULL;
+  data = g_bytes_get_data (bytes, &length);
+
+  if (!g_file_set_contents (self->filename, data, length, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void start_save (GfIconCache *self,
+                        GBytes      *bytes);
+
+static void
+save_cb (GObject      *object,
+         GAsyncResult *res,
+         gpointer      user_data)
+{
+  GfIconCache *self;
+  GError *error;
+  GBytes *pending_save;
+
+  self = GF_ICON_CACHE (object);
+
+  error = NULL;
+  g_task_propagate_boolean (G_TASK (res), &error);
+
+  if (error != NULL)
+    {
+      g_warning ("%s", error->message);
+      g_error_free (error);
+    }
+
+  self->saving = FALSE;
+
+  pending_save = g_steal_pointer (&self->pending_save);
+
+  if (pending_save != NULL)
+    {
+      start_save (self, pending_save);
+      g_bytes_unref (pending_save);
+    }
+}
+
+static void
+start_save (GfIconCache *self,
+            GBytes      *bytes)
+{
+  GTask *task;
+
+  if (self->saving)
+    {
+      g_clear_pointer (&self->pending_save, g_bytes_unref);
+      self->pending_save = g_bytes_ref (bytes);
+      return;
+    }
+
+  self->saving = TRUE;
+
+  task = g_task_new (self, NULL, save_cb, NULL);
+  g_task_set_task_data (task, g_bytes_ref (bytes), (GDestroyNotify) g_bytes_unref);
+
+  g_task_run_in_thread (task, save_in_thread);
+  g_object_unref (task);
+}
+
+static void
+gf_icon_cache_finalize (GObject *object)
+{
+  GfIconCache *self;
+
+  self = GF_ICON_CACHE (object);
+
+  g_clear_pointer (&self->directory, g_free);
+  g_clear_pointer (&self->filename, g_free);
+  g_clear_pointer (&self->locale, g_free);
+  g_clear_pointer (&self->pending_save, g_bytes_unref);
+
+  G_OBJECT_CLASS (gf_icon_cache_parent_class)->finalize (object);
+}
+
+static void
+gf_icon_cache_class_init (GfIconCacheClass *self_class)
+{
+  GObjectClass *object_class;
+
+  object_class = G_OBJECT_CLASS (self_class);
+
+  object_class->finalize = gf_icon_cache_finalize;
+}
+
+static void
+gf_icon_cache_init (GfIconCache *self)
+{
+}
+
+GfIconCache *
+gf_icon_cache_new (GFile *directory)
+{
+  GfIconCache *self;
+
+  self = g_object_new (GF_TYPE_ICON_CACHE, NULL);
+
+  self->directory = g_file_get_uri (directory);
+  self->filename = get_cache_filename (self->directory);
+  self->locale = get_cache_locale ();
+
+  return self;
+}
+
+void
+gf_icon_cache_load (GfIconCache     *self,
+                    GfIconCacheFunc  func,
+                    gpointer         user_data)
+{
+  GError *error;
+  GMappedFile *mapped_file;
+  const char *data;
+  gsize length;
+  const GfCacheHeader *header;
+  const GfCacheEntry *entries;
+  guint32 i;
+
+  error = NULL;
+  mapped_file = g_mapped_file_new (self->filename, FALSE, &error);
+
+  if (error != NULL)
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("%s", error->message);
+
+      g_error_free (error);
+      return;
+    }
+
+  data = g_mapped_file_get_contents (mapped_file);
+  length = g_mapped_file_get_length (mapped_file);
+
+  header = (const GfCacheHeader *) data;
+
+  if (data == NULL || !is_valid_header (self, data, length, header))
+    {
+      g_mapped_file_unref (mapped_file);
+      return;
+    }
+
+  entries = (const GfCacheEntry *) (data + sizeof (GfCacheHeader));
+
+  for (i = 0; i < header->n_entries; i++)
+    {
+      const char *uri;
+      GFileInfo *info;
+      GFile *file;
+
+      info = create_file_info (data, length, &entries[i], &uri);
+
+      if (info == NULL)
+        {
+          g_warning ("Desktop icon cache “%s” is corrupted", self->filename);
+          break;
+        }
+
+      file = g_file_new_for_uri (uri);
+      func (file, info, user_data);
+
+      g_object_unref (file);
+      g_object_unref (info);
+    }
+
+  g_mapped_file_unref (mapped_file);
+}
+
+void
+gf_icon_cache_save (GfIconCache *self,
+                    GPtrArray   *icons)
+{
+  GBytes *bytes;
+
+  bytes = serialize_icons (self, icons);
+  start_save (self, bytes);
+  g_bytes_unref (bytes);
+}
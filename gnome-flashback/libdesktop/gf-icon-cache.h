@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GF_ICON_CACHE_H
+#define GF_ICON_CACHE_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef void (* GfIconCacheFunc) (GFile     *file,
+                                  GFileInfo *info,
+                                  gpointer   user_data);
+
+#define GF_TYPE_ICON_CACHE (gf_icon_cache_get_type ())
+G_DECLARE_FINAL_TYPE (GfIconCache, gf_icon_cache, GF, ICON_CACHE, GObject)
+
+GfIconCache *gf_icon_cache_new  (GFile           *directory);
+
+void         gf_icon_cache_load (GfIconCache     *self,
+                                 GfIconCacheFunc  func,
+                                 gpointer         user_data);
+
+void         gf_icon_cache_save (GfIconCache     *self,
+                                 GPtrArray       *icons);
+
+G_END_DECLS
+
+#endif
@@ -28,17 +28,34 @@
 #include "gf-desktop-enums.h"
 #include "gf-dummy-icon.h"
 #include "gf-home-icon.h"
+#include "gf-icon-cache.h"
 #include "gf-icon.h"
 #include "gf-monitor-view.h"
 #include "gf-trash-icon.h"
 #include "gf-utils.h"
 #include "gf-workarea-watcher.h"
 
+#define N_FILES_PER_PAGE 100
+#define POPULATE_TIME_BUDGET_USEC 8000
+#define BATCH_TIMEOUT_MSEC 100
+#define SAVE_CACHE_TIMEOUT_SEC 5
+
 typedef struct
 {
   GtkWidget *icon;
+  char      *uri;
 
   GtkWidget *view;
+
+  gboolean   cached;
+
+  /* Sort keys are copied from the icon so that sorting does not need to
+   * call back into GfIcon and GFileInfo for every comparison.
+   */
+  gboolean   is_directory;
+  char      *name_collated;
+  guint64    time_modified;
+  guint64    size;
 } GfIconInfo;
 
 struct _GfIconView
@@ -66,7 +83,22 @@ struct _GfIconView
 
   GCancellable       *cancellable;
 
-  GList              *icons;
+  GFileEnumerator    *enumerator;
+  GQueue             *pending_files;
+  guint               populate_id;
+  gboolean            populated;
+
+  GPtrArray          *icons;
+  GHashTable         *icons_by_uri;
+
+  GfIconCache        *icon_cache;
+  guint               save_cache_id;
+
+  GHashTable         *changed_icons;
+  GHashTable         *created_files;
+  int                 n_pending_queries;
+  gboolean            relayout_pending;
+  guint               batch_id;
 
   GfIconInfo         *home_info;
   GfIconInfo         *trash_info;
@@ -164,6 +196,22 @@ build_attributes_list (const char *first,
   return g_string_free (attributes, FALSE);
 }
 
+static void
+update_sort_key (GfIconInfo *info)
+{
+  GfIcon *icon;
+
+  icon = GF_ICON (info->icon);
+
+  info->is_directory = gf_icon_get_file_type (icon) == G_FILE_TYPE_DIRECTORY;
+
+  g_free (info->name_collated);
+  info->name_collated = g_strdup (gf_icon_get_name_collated (icon));
+
+  info->time_modified = gf_icon_get_time_modified (icon);
+  info->size = gf_icon_get_size (icon);
+}
+
 static GfIconInfo *
 gf_icon_info_new (GtkWidget *icon)
 {
@@ -171,9 +219,12 @@ gf_icon_info_new (GtkWidget *icon)
 
   info = g_new0 (GfIconInfo, 1);
   info->icon = g_object_ref_sink (icon);
+  info->uri = g_file_get_uri (gf_icon_get_file (GF_ICON (icon)));
 
   info->view = NULL;
 
+  update_sort_key (info);
+
   return info;
 }
 
@@ -185,284 +236,420 @@ gf_icon_info_free (gpointer data)
   info = (GfIconInfo *) data;
 
   g_clear_pointer (&info->icon, g_object_unref);
+  g_clear_pointer (&info->uri, g_free);
+  g_clear_pointer (&info->name_collated, g_free);
   g_free (info);
 }
 
-static GList *
-get_monitor_views (GfIconView *self)
+static int
+compare_uint64 (guint64 a,
+                guint64 b)
 {
-  GList *views;
-  GList *children;
-  GList *l;
+  if (a < b)
+    return -1;
+  else if (a > b)
+    return 1;
 
-  views = NULL;
+  return 0;
+}
 
-  children = gtk_container_get_children (GTK_CONTAINER (self->fixed));
+static int
+compare_icon_infos (const GfIconInfo *a,
+                    const GfIconInfo *b,
+                    GfSortBy          sort_by)
+{
+  if (a->is_directory != b->is_directory)
+    return a->is_directory ? -1 : 1;
 
-  for (l = children; l != NULL; l = l->next)
+  if (sort_by == GF_SORT_BY_NAME)
+    return g_strcmp0 (a->name_collated, b->name_collated);
+  else if (sort_by == GF_SORT_BY_DATE_MODIFIED)
+    return compare_uint64 (a->time_modified, b->time_modified);
+  else if (sort_by == GF_SORT_BY_SIZE)
+    return compare_uint64 (a->size, b->size);
+
+  return 0;
+}
+
+static int
+compare_func (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+  GfIconView *self;
+
+  self = GF_ICON_VIEW (user_data);
+
+  return compare_icon_infos (a, b, self->sort_by);
+}
+
+static guint
+find_sorted_index (GfIconView *self,
+                   GfIconInfo *info)
+{
+  guint low;
+  guint high;
+
+  low = 0;
+  high = self->icons->len;
+
+  /* Equal icons keep their insertion order */
+  while (low < high)
     {
-      GfMonitorView *view;
+      guint middle;
+      GfIconInfo *middle_info;
 
-      view = GF_MONITOR_VIEW (l->data);
+      middle = low + (high - low) / 2;
+      middle_info = g_ptr_array_index (self->icons, middle);
 
-      if (gf_monitor_view_is_primary (view))
-        views = g_list_prepend (views, view);
+      if (compare_icon_infos (middle_info, info, self->sort_by) <= 0)
+        low = middle + 1;
       else
-        views = g_list_append (views, view);
+        high = middle;
     }
 
-  g_list_free (children);
-  return views;
+  return low;
 }
 
-static void
-add_icons (GfIconView *self)
+static gboolean
+find_icon_info_index (GfIconView *self,
+                      GfIconInfo *info,
+                      guint      *index)
 {
-  GList *views;
-  GList *view;
-  GList *l;
+  guint low;
+  guint high;
 
-  views = get_monitor_views (self);
-  view = views;
+  if (self->placement != GF_PLACEMENT_AUTO_ARRANGE_ICONS)
+    return g_ptr_array_find (self->icons, info, index);
 
-  for (l = self->icons; l != NULL; l = l->next)
-    {
-      GfIconInfo *info;
+  low = 0;
+  high = self->icons->len;
 
-      info = (GfIconInfo *) l->data;
+  /* Find the first icon that sorts equal to info... */
+  while (low < high)
+    {
+      guint middle;
+      GfIconInfo *middle_info;
 
-      if (gf_icon_is_hidden (GF_ICON (info->icon)))
-        continue;
+      middle = low + (high - low) / 2;
+      middle_info = g_ptr_array_index (self->icons, middle);
 
-      if (info->view != NULL)
-        continue;
+      if (compare_icon_infos (middle_info, info, self->sort_by) < 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
 
-      while (view != NULL)
-        {
-          if (!gf_monitor_view_add_icon (GF_MONITOR_VIEW (view->data),
-                                         info->icon))
-            {
-              view = view->next;
-              continue;
-            }
+  /* ... and look for info among the equal ones */
+  for (; low < self->icons->len; low++)
+    {
+      GfIconInfo *low_info;
 
-          info->view = view->data;
+      low_info = g_ptr_array_index (self->icons, low);
 
-          break;
+      if (low_info == info)
+        {
+          *index = low;
+          return TRUE;
         }
 
-      if (view == NULL)
+      if (compare_icon_infos (low_info, info, self->sort_by) != 0)
         break;
     }
 
-  g_list_free (views);
+  /* Not expected, icons are resorted as soon as the order changes */
+  return g_ptr_array_find (self->icons, info, index);
 }
 
-static int
-compare_directory (GfIcon     *a,
-                   GfIcon     *b,
-                   GfIconView *self)
+static void
+add_icon_info (GfIconView *self,
+               GfIconInfo *info)
 {
-  gboolean is_dir_a;
-  gboolean is_dir_b;
-
-  is_dir_a = gf_icon_get_file_type (a) == G_FILE_TYPE_DIRECTORY;
-  is_dir_b = gf_icon_get_file_type (b) == G_FILE_TYPE_DIRECTORY;
-
-  if (is_dir_a != is_dir_b)
-    return is_dir_a ? -1 : 1;
+  /* Without auto-arrange icons are kept in arrival order, which is also
+   * the order in which they are placed while the desktop is populated.
+   */
+  if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
+    g_ptr_array_insert (self->icons, find_sorted_index (self, info), info);
+  else
+    g_ptr_array_add (self->icons, info);
 
-  return 0;
+  g_hash_table_replace (self->icons_by_uri, info->uri, info);
 }
 
-static int
-compare_name (GfIcon     *a,
-              GfIcon     *b,
-              GfIconView *self)
+static void
+update_icon_info_sort_key (GfIconView *self,
+                           GfIconInfo *info)
 {
-  const char *name_a;
-  const char *name_b;
+  guint index;
+  GfIconInfo *prev;
+  GfIconInfo *next;
+
+  if (self->placement != GF_PLACEMENT_AUTO_ARRANGE_ICONS)
+    {
+      update_sort_key (info);
+      return;
+    }
+
+  /* The icons are sorted by the old key */
+  if (!find_icon_info_index (self, info, &index))
+    {
+      update_sort_key (info);
+      return;
+    }
 
-  name_a = gf_icon_get_name_collated (a);
-  name_b = gf_icon_get_name_collated (b);
+  update_sort_key (info);
 
-  return g_strcmp0 (name_a, name_b);
+  prev = index > 0 ? g_ptr_array_index (self->icons, index - 1) : NULL;
+  next = index + 1 < self->icons->len ? g_ptr_array_index (self->icons, index + 1) : NULL;
+
+  if ((prev == NULL || compare_icon_infos (prev, info, self->sort_by) <= 0) &&
+      (next == NULL || compare_icon_infos (info, next, self->sort_by) <= 0))
+    return;
+
+  g_ptr_array_steal_index (self->icons, index);
+  g_ptr_array_insert (self->icons, find_sorted_index (self, info), info);
 }
 
-static int
-compare_modified (GfIcon     *a,
-                  GfIcon     *b,
-                  GfIconView *self)
+static void
+remove_icon_info (GfIconView *self,
+                  GfIconInfo *info)
 {
-  guint64 modified_a;
-  guint64 modified_b;
+  guint index;
 
-  modified_a = gf_icon_get_time_modified (a);
-  modified_b = gf_icon_get_time_modified (b);
+  if (g_hash_table_lookup (self->icons_by_uri, info->uri) == info)
+    g_hash_table_remove (self->icons_by_uri, info->uri);
 
-  if (modified_a < modified_b)
-    return -1;
-  else if (modified_a > modified_b)
-    return 1;
-
-  return 0;
+  if (find_icon_info_index (self, info, &index))
+    g_ptr_array_remove_index (self->icons, index);
 }
 
-static int
-compare_size (GfIcon     *a,
-              GfIcon     *b,
-              GfIconView *self)
+static void
+update_icon_info_uri (GfIconView *self,
+                      GfIconInfo *info)
 {
-  guint64 size_a;
-  guint64 size_b;
+  if (g_hash_table_lookup (self->icons_by_uri, info->uri) == info)
+    g_hash_table_remove (self->icons_by_uri, info->uri);
 
-  size_a = gf_icon_get_size (a);
-  size_b = gf_icon_get_size (b);
+  g_free (info->uri);
+  info->uri = g_file_get_uri (gf_icon_get_file (GF_ICON (info->icon)));
 
-  if (size_a < size_b)
-    return -1;
-  else if (size_a > size_b)
-    return 1;
-
-  return 0;
+  g_hash_table_replace (self->icons_by_uri, info->uri, info);
 }
 
-static int
-compare_name_func (gconstpointer a,
-                   gconstpointer b,
-                   gpointer      user_data)
+static GfIconInfo *
+find_icon_info_by_file (GfIconView *self,
+                        GFile      *file)
 {
-  GfIconView *self;
-  GfIconInfo *info_a;
-  GfIcon *icon_a;
-  GfIconInfo *info_b;
-  GfIcon *icon_b;
-  int result;
+  char *uri;
+  GfIconInfo *info;
 
-  self = GF_ICON_VIEW (user_data);
+  uri = g_file_get_uri (file);
+  info = g_hash_table_lookup (self->icons_by_uri, uri);
+  g_free (uri);
 
-  info_a = (GfIconInfo *) a;
-  icon_a = GF_ICON (info_a->icon);
+  return info;
+}
 
-  info_b = (GfIconInfo *) b;
-  icon_b = GF_ICON (info_b->icon);
+static GfIconInfo *
+find_icon_info_by_icon (GfIconView *self,
+                        GfIcon     *icon)
+{
+  GfIconInfo *info;
 
-  result = compare_directory (icon_a, icon_b, self);
+  info = find_icon_info_by_file (self, gf_icon_get_file (icon));
 
-  if (result == 0)
-    result = compare_name (icon_a, icon_b, self);
+  if (info == NULL || info->icon != GTK_WIDGET (icon))
+    return NULL;
 
-  return result;
+  return info;
 }
 
-static int
-compare_modified_func (gconstpointer a,
-                       gconstpointer b,
-                       gpointer      user_data)
+static GList *
+get_monitor_views (GfIconView *self)
 {
-  GfIconView *self;
-  GfIconInfo *info_a;
-  GfIcon *icon_a;
-  GfIconInfo *info_b;
-  GfIcon *icon_b;
-  int result;
+  GList *views;
+  GList *children;
+  GList *l;
 
-  self = GF_ICON_VIEW (user_data);
+  views = NULL;
 
-  info_a = (GfIconInfo *) a;
-  icon_a = GF_ICON (info_a->icon);
+  children = gtk_container_get_children (GTK_CONTAINER (self->fixed));
 
-  info_b = (GfIconInfo *) b;
-  icon_b = GF_ICON (info_b->icon);
+  for (l = children; l != NULL; l = l->next)
+    {
+      GfMonitorView *view;
 
-  result = compare_directory (icon_a, icon_b, self);
+      view = GF_MONITOR_VIEW (l->data);
 
-  if (result == 0)
-    result = compare_modified (icon_a, icon_b, self);
+      if (gf_monitor_view_is_primary (view))
+        views = g_list_prepend (views, view);
+      else
+        views = g_list_append (views, view);
+    }
 
-  return result;
+  g_list_free (children);
+  return views;
 }
 
-static int
-compare_size_func (gconstpointer a,
-                   gconstpointer b,
-                   gpointer      user_data)
+static void
+add_icons (GfIconView *self)
 {
-  GfIconView *self;
-  GfIconInfo *info_a;
-  GfIcon *icon_a;
-  GfIconInfo *info_b;
-  GfIcon *icon_b;
-  int result;
+  GList *views;
+  GList *view;
+  guint i;
 
-  self = GF_ICON_VIEW (user_data);
+  views = get_monitor_views (self);
+  view = views;
+
+  for (i = 0; i < self->icons->len; i++)
+    {
+      GfIconInfo *info;
 
-  info_a = (GfIconInfo *) a;
-  icon_a = GF_ICON (info_a->icon);
+      info = g_ptr_array_index (self->icons, i);
 
-  info_b = (GfIconInfo *) b;
-  icon_b = GF_ICON (info_b->icon);
+      if (gf_icon_is_hidden (GF_ICON (info->icon)))
+        continue;
+
+      if (info->view != NULL)
+        continue;
+
+      while (view != NULL)
+        {
+          if (!gf_monitor_view_add_icon (GF_MONITOR_VIEW (view->data),
+                                         info->icon))
+            {
+              view = view->next;
+              continue;
+            }
+
+          info->view = view->data;
 
-  result = compare_directory (icon_a, icon_b, self);
+          break;
+        }
 
-  if (result == 0)
-    result = compare_size (icon_a, icon_b, self);
+      if (view == NULL)
+        break;
+    }
 
-  return result;
+  g_list_free (views);
 }
 
 static gboolean
 sort_icons (GfIconView *self)
 {
-  GList *old_list;
+  gpointer *old_icons;
   gboolean changed;
-  GList *l1;
-  GList *l2;
+  guint i;
+
+  if (self->icons->len == 0)
+    return FALSE;
 
-  old_list = g_list_copy (self->icons);
+  old_icons = g_memdup2 (self->icons->pdata,
+                         self->icons->len * sizeof (gpointer));
 
-  if (self->sort_by == GF_SORT_BY_NAME)
-    self->icons = g_list_sort_with_data (self->icons, compare_name_func, self);
-  else if (self->sort_by == GF_SORT_BY_DATE_MODIFIED)
-    self->icons = g_list_sort_with_data (self->icons, compare_modified_func, self);
-  else if (self->sort_by == GF_SORT_BY_SIZE)
-    self->icons = g_list_sort_with_data (self->icons, compare_size_func, self);
+  /* This is a stable sort, icons with equal sort keys keep their order */
+  g_ptr_array_sort_values_with_data (self->icons, compare_func, self);
 
   changed = FALSE;
-  for (l1 = self->icons, l2 = old_list;
-       l1 != NULL;
-       l1 = l1->next, l2 = l2->next)
+  for (i = 0; i < self->icons->len; i++)
     {
-      if (l1->data == l2->data)
+      if (g_ptr_array_index (self->icons, i) == old_icons[i])
         continue;
 
       changed = TRUE;
       break;
     }
 
-  g_list_free (old_list);
+  g_free (old_icons);
   return changed;
 }
 
+typedef struct
+{
+  GtkWidget *view;
+  int        cell;
+} GfIconTarget;
+
 static void
-remove_and_readd_icons (GfIconView *self)
+relayout_icons (GfIconView *self)
 {
-  GList *l;
+  GList *views;
+  GList *view;
+  int n_cells;
+  int cell;
+  GfIconTarget *targets;
+  guint i;
 
-  for (l = self->icons; l != NULL; l = l->next)
+  views = get_monitor_views (self);
+  view = views;
+
+  n_cells = view != NULL ? gf_monitor_view_get_n_cells (view->data) : 0;
+  cell = 0;
+
+  targets = g_new0 (GfIconTarget, self->icons->len);
+
+  /* Compute the cell that every icon should end up in. Icons are laid
+   * out the same way as add_icons() would lay them out on empty views.
+   */
+  for (i = 0; i < self->icons->len; i++)
     {
       GfIconInfo *info;
 
-      info = (GfIconInfo *) l->data;
+      info = g_ptr_array_index (self->icons, i);
 
-      if (info->view == NULL)
+      if (gf_icon_is_hidden (GF_ICON (info->icon)))
+        continue;
+
+      while (view != NULL && cell >= n_cells)
+        {
+          view = view->next;
+          cell = 0;
+
+          if (view != NULL)
+            n_cells = gf_monitor_view_get_n_cells (view->data);
+        }
+
+      if (view == NULL)
+        break;
+
+      targets[i].view = view->data;
+      targets[i].cell = cell++;
+    }
+
+  /* Only icons whose view or cell changed are touched, icons that are
+   * already in the right place are not removed and re-added.
+   */
+  for (i = 0; i < self->icons->len; i++)
+    {
+      GfIconInfo *info;
+
+      info = g_ptr_array_index (self->icons, i);
+
+      if (info->view == NULL || info->view == targets[i].view)
         continue;
 
       gf_monitor_view_remove_icon (GF_MONITOR_VIEW (info->view), info->icon);
       info->view = NULL;
     }
 
-  add_icons (self);
+  for (i = 0; i < self->icons->len; i++)
+    {
+      GfIconInfo *info;
+
+      info = g_ptr_array_index (self->icons, i);
+
+      if (targets[i].view == NULL)
+        continue;
+
+      gf_monitor_view_place_icon (GF_MONITOR_VIEW (targets[i].view),
+                                  info->icon,
+                                  targets[i].cell);
+
+      info->view = targets[i].view;
+    }
+
+  g_free (targets);
+  g_list_free (views);
 }
 
 static void
@@ -472,7 +659,7 @@ resort_icons (GfIconView *self,
   if (!sort_icons (self) && !force)
     return;
 
-  remove_and_readd_icons (self);
+  relayout_icons (self);
 }
 
 static void
@@ -679,77 +866,159 @@ create_icon_info (GfIconView *self,
   return gf_icon_info_new (icon);
 }
 
+static gboolean
+save_cache_cb (gpointer user_data)
+{
+  GfIconView *self;
+  GPtrArray *icons;
+  guint i;
+
+  self = GF_ICON_VIEW (user_data);
+  self->save_cache_id = 0;
+
+  /* The cache is saved again when population is finished */
+  if (self->enumerator != NULL || self->populate_id != 0)
+    return G_SOURCE_REMOVE;
+
+  icons = g_ptr_array_sized_new (self->icons->len);
+
+  for (i = 0; i < self->icons->len; i++)
+    {
+      GfIconInfo *info;
+
+      info = g_ptr_array_index (self->icons, i);
+      g_ptr_array_add (icons, info->icon);
+    }
+
+  gf_icon_cache_save (self->icon_cache, icons);
+  g_ptr_array_free (icons, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
-icon_changed_cb (GfIcon     *icon,
-                 GfIconView *self)
+schedule_save_cache (GfIconView *self)
+{
+  if (self->icon_cache == NULL || self->save_cache_id != 0)
+    return;
+
+  self->save_cache_id = g_timeout_add_seconds (SAVE_CACHE_TIMEOUT_SEC,
+                                               save_cache_cb,
+                                               self);
+
+  g_source_set_name_by_id (self->save_cache_id,
+                           "[gnome-flashback] save_cache_cb");
+}
+
+static void
+flush_relayout (GfIconView *self)
 {
+  if (!self->relayout_pending || self->n_pending_queries > 0)
+    return;
+
+  self->relayout_pending = FALSE;
+
+  /* Icons are kept sorted when they are added or changed */
   if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-    resort_icons (self, FALSE);
+    relayout_icons (self);
+  else
+    add_icons (self);
 }
 
 static void
-query_info_cb (GObject      *object,
-               GAsyncResult *res,
-               gpointer      user_data)
+changed_icons_foreach_cb (gpointer key,
+                          gpointer value,
+                          gpointer user_data)
 {
-  GFile *file;
-  GFileInfo *file_info;
-  GError *error;
   GfIconView *self;
-  GtkWidget *icon;
-  GfIconInfo *icon_info;
+  GfIconInfo *info;
 
-  file = G_FILE (object);
+  self = GF_ICON_VIEW (user_data);
+  info = g_hash_table_lookup (self->icons_by_uri, key);
 
-  error = NULL;
-  file_info = g_file_query_info_finish (file, res, &error);
+  if (info != NULL)
+    gf_icon_update (GF_ICON (info->icon));
+}
 
-  if (error != NULL)
-    {
-      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("%s", error->message);
+static void query_info_cb (GObject      *object,
+                           GAsyncResult *res,
+                           gpointer      user_data);
 
-      g_error_free (error);
-      return;
-    }
+static void
+created_files_foreach_cb (gpointer key,
+                          gpointer value,
+                          gpointer user_data)
+{
+  GfIconView *self;
+  char *attributes;
 
   self = GF_ICON_VIEW (user_data);
+  attributes = gf_icon_view_get_file_attributes (self);
 
-  icon = gf_icon_new (self, file, file_info);
-  g_object_unref (file_info);
+  self->n_pending_queries++;
 
-  g_signal_connect (icon, "changed", G_CALLBACK (icon_changed_cb), self);
+  g_file_query_info_async (G_FILE (value),
+                           attributes,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_LOW,
+                           self->cancellable,
+                           query_info_cb,
+                           self);
 
-  icon_info = create_icon_info (self, icon);
-  self->icons = g_list_prepend (self->icons, icon_info);
+  g_free (attributes);
+}
 
-  if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-    resort_icons (self, TRUE);
-  else
-    add_icons (self);
+static gboolean
+batch_cb (gpointer user_data)
+{
+  GfIconView *self;
 
-  gf_icon_update (GF_ICON (icon));
+  self = GF_ICON_VIEW (user_data);
+  self->batch_id = 0;
+
+  g_hash_table_foreach (self->changed_icons, changed_icons_foreach_cb, self);
+  g_hash_table_remove_all (self->changed_icons);
+
+  g_hash_table_foreach (self->created_files, created_files_foreach_cb, self);
+  g_hash_table_remove_all (self->created_files);
+
+  flush_relayout (self);
+
+  return G_SOURCE_REMOVE;
 }
 
-static GfIconInfo *
-find_icon_info_by_file (GfIconView *self,
-                        GFile      *file)
+static void
+schedule_batch (GfIconView *self)
 {
-  GList *l;
+  if (self->batch_id != 0)
+    return;
 
-  for (l = self->icons; l != NULL; l = l->next)
-    {
-      GfIconInfo *info;
-      GFile *icon_file;
+  self->batch_id = g_timeout_add (BATCH_TIMEOUT_MSEC, batch_cb, self);
+  g_source_set_name_by_id (self->batch_id, "[gnome-flashback] batch_cb");
+}
 
-      info = (GfIconInfo *) l->data;
-      icon_file = gf_icon_get_file (GF_ICON (info->icon));
+static void
+queue_relayout (GfIconView *self)
+{
+  self->relayout_pending = TRUE;
+  schedule_batch (self);
+}
 
-      if (g_file_equal (icon_file, file))
-        return info;
-    }
+static void
+icon_changed_cb (GfIcon     *icon,
+                 GfIconView *self)
+{
+  GfIconInfo *info;
 
-  return NULL;
+  info = find_icon_info_by_icon (self, icon);
+
+  if (info != NULL)
+    update_icon_info_sort_key (self, info);
+
+  if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
+    queue_relayout (self);
+
+  schedule_save_cache (self);
 }
 
 static void
@@ -763,17 +1032,81 @@ remove_icon_from_view (GfIconView *self,
 
   icon = GF_ICON (info->icon);
 
-  gf_monitor_view_remove_icon (GF_MONITOR_VIEW (info->view), GTK_WIDGET (icon));
-  info->view = NULL;
+  gf_monitor_view_remove_icon (GF_MONITOR_VIEW (info->view), GTK_WIDGET (icon));
+  info->view = NULL;
+
+  self->selected_icons = g_list_remove (self->selected_icons, icon);
+  self->rubberband_icons = g_list_remove (self->rubberband_icons, icon);
+
+  if (icon == self->last_selected_icon)
+    self->last_selected_icon = NULL;
+
+  if (icon == self->extend_from_icon)
+    self->extend_from_icon = NULL;
+}
+
+static void
+query_info_cb (GObject      *object,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+  GFile *file;
+  GFileInfo *file_info;
+  GError *error;
+  GfIconView *self;
+  GtkWidget *icon;
+  GfIconInfo *icon_info;
+  GfIconInfo *old_info;
+
+  file = G_FILE (object);
+
+  error = NULL;
+  file_info = g_file_query_info_finish (file, res, &error);
+
+  if (error != NULL)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_error_free (error);
+          return;
+        }
+
+      self = GF_ICON_VIEW (user_data);
+      self->n_pending_queries--;
+
+      /* Usually the file was deleted before it was queried */
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        g_warning ("%s", error->message);
+
+      g_error_free (error);
+
+      flush_relayout (self);
+      return;
+    }
+
+  self = GF_ICON_VIEW (user_data);
+  self->n_pending_queries--;
+
+  icon = gf_icon_new (self, file, file_info);
+  g_object_unref (file_info);
+
+  g_signal_connect (icon, "changed", G_CALLBACK (icon_changed_cb), self);
+
+  old_info = find_icon_info_by_file (self, file);
+  if (old_info != NULL)
+    {
+      remove_icon_from_view (self, old_info);
+      remove_icon_info (self, old_info);
+    }
 
-  self->selected_icons = g_list_remove (self->selected_icons, icon);
-  self->rubberband_icons = g_list_remove (self->rubberband_icons, icon);
+  icon_info = create_icon_info (self, icon);
+  add_icon_info (self, icon_info);
 
-  if (icon == self->last_selected_icon)
-    self->last_selected_icon = NULL;
+  self->relayout_pending = TRUE;
+  flush_relayout (self);
 
-  if (icon == self->extend_from_icon)
-    self->extend_from_icon = NULL;
+  gf_icon_update (GF_ICON (icon));
+  schedule_save_cache (self);
 }
 
 static void
@@ -781,12 +1114,41 @@ remove_icon (GfIconView *self,
              GfIconInfo *info)
 {
   remove_icon_from_view (self, info);
-
-  self->icons = g_list_remove (self->icons, info);
-  gf_icon_info_free (info);
+  remove_icon_info (self, info);
 
   if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-    remove_and_readd_icons (self);
+    queue_relayout (self);
+
+  schedule_save_cache (self);
+}
+
+static void
+remove_pending_file (GfIconView *self,
+                     GFile      *file)
+{
+  char *name;
+  GList *l;
+
+  if (g_queue_is_empty (self->pending_files))
+    return;
+
+  name = g_file_get_basename (file);
+
+  for (l = self->pending_files->head; l != NULL; l = l->next)
+    {
+      GFileInfo *info;
+
+      info = l->data;
+
+      if (g_strcmp0 (g_file_info_get_name (info), name) == 0)
+        {
+          g_queue_delete_link (self->pending_files, l);
+          g_object_unref (info);
+          break;
+        }
+    }
+
+  g_free (name);
 }
 
 static void
@@ -794,6 +1156,13 @@ file_deleted (GfIconView *self,
               GFile      *deleted_file)
 {
   GfIconInfo *info;
+  char *uri;
+
+  remove_pending_file (self, deleted_file);
+
+  uri = g_file_get_uri (deleted_file);
+  g_hash_table_remove (self->created_files, uri);
+  g_free (uri);
 
   info = find_icon_info_by_file (self, deleted_file);
 
@@ -807,19 +1176,11 @@ static void
 file_created (GfIconView *self,
               GFile      *created_file)
 {
-  char *attributes;
-
-  attributes = gf_icon_view_get_file_attributes (self);
-
-  g_file_query_info_async (created_file,
-                           attributes,
-                           G_FILE_QUERY_INFO_NONE,
-                           G_PRIORITY_LOW,
-                           self->cancellable,
-                           query_info_cb,
-                           self);
+  g_hash_table_replace (self->created_files,
+                        g_file_get_uri (created_file),
+                        g_object_ref (created_file));
 
-  g_free (attributes);
+  schedule_batch (self);
 }
 
 static void
@@ -841,6 +1202,7 @@ file_renamed (GfIconView *self,
   else if (old_info != NULL)
     {
       gf_icon_set_file (GF_ICON (old_info->icon), new_file);
+      update_icon_info_uri (self, old_info);
     }
   else if (new_info != NULL)
     {
@@ -848,6 +1210,24 @@ file_renamed (GfIconView *self,
     }
 }
 
+static void
+file_changed (GfIconView *self,
+              GFile      *changed_file)
+{
+  char *uri;
+
+  uri = g_file_get_uri (changed_file);
+
+  if (!g_hash_table_contains (self->icons_by_uri, uri))
+    {
+      g_free (uri);
+      return;
+    }
+
+  g_hash_table_add (self->changed_icons, uri);
+  schedule_batch (self);
+}
+
 static void
 desktop_changed_cb (GFileMonitor      *monitor,
                     GFile             *file,
@@ -861,6 +1241,7 @@ desktop_changed_cb (GFileMonitor      *monitor,
         break;
 
       case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        file_changed (self, file);
         break;
 
       case G_FILE_MONITOR_EVENT_DELETED:
@@ -872,6 +1253,7 @@ desktop_changed_cb (GFileMonitor      *monitor,
         break;
 
       case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+        file_changed (self, file);
         break;
 
       case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
@@ -1441,6 +1823,20 @@ multi_press_pressed_cb (GtkGestureMultiPress *gesture,
     }
 }
 
+static void
+queue_draw_rubberband (GfIconView         *self,
+                       const GdkRectangle *rect)
+{
+  if (rect->width <= 0 || rect->height <= 0)
+    return;
+
+  gtk_widget_queue_draw_area (GTK_WIDGET (self),
+                              rect->x,
+                              rect->y,
+                              rect->width,
+                              rect->height);
+}
+
 static void
 drag_begin_cb (GtkGestureDrag *gesture,
                gdouble         start_x,
@@ -1448,8 +1844,6 @@ drag_begin_cb (GtkGestureDrag *gesture,
                GfIconView     *self)
 {
   self->rubberband_rect = (GdkRectangle) { 0 };
-
-  gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
 static void
@@ -1459,7 +1853,7 @@ drag_end_cb (GtkGestureDrag *gesture,
              GfIconView     *self)
 {
   g_clear_pointer (&self->rubberband_icons, g_list_free);
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  queue_draw_rubberband (self, &self->rubberband_rect);
 }
 
 static void
@@ -1585,7 +1979,9 @@ drag_update_cb (GtkGestureDrag *gesture,
         }
     }
 
-  gtk_widget_queue_draw (GTK_WIDGET (self));
+  /* Only the area covered by the old and the new rectangle changed */
+  queue_draw_rubberband (self, &old_rect);
+  queue_draw_rubberband (self, &self->rubberband_rect);
 }
 
 static void
@@ -1593,23 +1989,16 @@ view_foreach_cb (GtkWidget *widget,
                  gpointer   user_data)
 {
   GfIconView *self;
-  GList *l;
+  GfIconInfo *info;
 
   self = GF_ICON_VIEW (user_data);
 
-  for (l = self->icons; l != NULL; l = l->next)
-    {
-      GfIconInfo *info;
-
-      info = (GfIconInfo *) l->data;
+  info = find_icon_info_by_icon (self, GF_ICON (widget));
+  if (info == NULL)
+    return;
 
-      if (info->icon == widget)
-        {
-          gtk_container_remove (GTK_CONTAINER (info->view), widget);
-          info->view = NULL;
-          break;
-        }
-    }
+  gtk_container_remove (GTK_CONTAINER (info->view), widget);
+  info->view = NULL;
 }
 
 static void
@@ -1640,7 +2029,7 @@ append_home_icon (GfIconView *self)
     }
 
   self->home_info = create_icon_info (self, icon);
-  self->icons = g_list_prepend (self->icons, self->home_info);
+  add_icon_info (self, self->home_info);
 }
 
 static void
@@ -1663,9 +2052,187 @@ append_trash_icon (GfIconView *self)
     }
 
   self->trash_info = create_icon_info (self, icon);
-  self->icons = g_list_prepend (self->icons, self->trash_info);
+  add_icon_info (self, self->trash_info);
+}
+
+static void
+create_icon_from_file_info (GfIconView *self,
+                            GFileInfo  *info)
+{
+  GFile *file;
+  GtkWidget *icon;
+  GfIconInfo *icon_info;
+
+  file = g_file_get_child (self->desktop, g_file_info_get_name (info));
+
+  icon_info = find_icon_info_by_file (self, file);
+
+  /* Already created from the cache or from a file monitor event */
+  if (icon_info != NULL)
+    {
+      if (icon_info->cached)
+        {
+          GfIcon *cached_icon;
+          guint64 time_modified;
+          guint64 size;
+
+          icon_info->cached = FALSE;
+          cached_icon = GF_ICON (icon_info->icon);
+
+          time_modified = g_file_info_get_attribute_uint64 (info,
+                                                            G_FILE_ATTRIBUTE_TIME_MODIFIED);
+          size = g_file_info_get_attribute_uint64 (info,
+                                                   G_FILE_ATTRIBUTE_STANDARD_SIZE);
+
+          /* Names, icons and hidden flags are always taken from the
+           * enumerated info, only the thumbnail of an unchanged file
+           * is still valid.
+           */
+          if (gf_icon_get_time_modified (cached_icon) == time_modified &&
+              gf_icon_get_size (cached_icon) == size)
+            {
+              GFileInfo *cached_info;
+
+              const char *attribute;
+
+              cached_info = gf_icon_get_file_info (cached_icon);
+              attribute = GF_ICON_ATTRIBUTE_THUMBNAIL_PATH;
+
+              if (g_file_info_has_attribute (cached_info, attribute))
+                {
+                  const char *thumbnail_path;
+
+                  thumbnail_path = g_file_info_get_attribute_byte_string (cached_info,
+                                                                          attribute);
+
+                  g_file_info_set_attribute_byte_string (info,
+                                                         attribute,
+                                                         thumbnail_path);
+                }
+            }
+
+          gf_icon_set_file_info (cached_icon, info);
+        }
+
+      g_object_unref (file);
+      return;
+    }
+
+  icon = gf_icon_new (self, file, info);
+  g_object_unref (file);
+
+  g_signal_connect (icon, "changed", G_CALLBACK (icon_changed_cb), self);
+
+  icon_info = create_icon_info (self, icon);
+  add_icon_info (self, icon_info);
+}
+
+static void
+remove_stale_cached_icons (GfIconView *self)
+{
+  guint n_icons;
+  guint i;
+
+  /* Remaining icons are moved to the front in one pass, keeping their
+   * order, and the stale ones are freed together from the end.
+   */
+  n_icons = 0;
+  for (i = 0; i < self->icons->len; i++)
+    {
+      GfIconInfo *info;
+
+      info = g_ptr_array_index (self->icons, i);
+
+      if (info->cached)
+        {
+          remove_icon_from_view (self, info);
+
+          if (g_hash_table_lookup (self->icons_by_uri, info->uri) == info)
+            g_hash_table_remove (self->icons_by_uri, info->uri);
+
+          continue;
+        }
+
+      self->icons->pdata[i] = self->icons->pdata[n_icons];
+      self->icons->pdata[n_icons++] = info;
+    }
+
+  g_ptr_array_remove_range (self->icons, n_icons, self->icons->len - n_icons);
+}
+
+static void
+population_finished (GfIconView *self)
+{
+  remove_stale_cached_icons (self);
+
+  /* Icons are kept sorted while they are added, but they were placed in
+   * arrival order and removed cached icons left holes, so the layout has
+   * to be redone even if the sort order did not change.
+   */
+  if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
+    resort_icons (self, TRUE);
+
+  add_icons (self);
+  schedule_save_cache (self);
+
+  self->populated = TRUE;
+}
+
+static gboolean
+populate_cb (gpointer user_data)
+{
+  GfIconView *self;
+  gint64 end_time;
+
+  self = GF_ICON_VIEW (user_data);
+  end_time = g_get_monotonic_time () + POPULATE_TIME_BUDGET_USEC;
+
+  while (!g_queue_is_empty (self->pending_files))
+    {
+      GFileInfo *info;
+
+      info = g_queue_pop_head (self->pending_files);
+      create_icon_from_file_info (self, info);
+      g_object_unref (info);
+
+      if (g_get_monotonic_time () >= end_time)
+        break;
+    }
+
+  /* Icons are placed in enumeration order while the desktop is being
+   * populated, so that the first icons can be painted right away. They
+   * are sorted once when everything has been enumerated.
+   */
+  add_icons (self);
+
+  if (!g_queue_is_empty (self->pending_files))
+    return G_SOURCE_CONTINUE;
+
+  self->populate_id = 0;
+
+  if (self->enumerator == NULL)
+    population_finished (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_populate (GfIconView *self)
+{
+  if (self->populate_id != 0)
+    return;
+
+  self->populate_id = g_idle_add_full (G_PRIORITY_LOW,
+                                       populate_cb,
+                                       self,
+                                       NULL);
+
+  g_source_set_name_by_id (self->populate_id,
+                           "[gnome-flashback] populate_cb");
 }
 
+static void next_files (GfIconView *self);
+
 static void
 next_files_cb (GObject      *object,
                GAsyncResult *res,
@@ -1684,46 +2251,46 @@ next_files_cb (GObject      *object,
 
   if (error != NULL)
     {
-      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("%s", error->message);
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_error_free (error);
+          return;
+        }
 
+      g_warning ("%s", error->message);
       g_error_free (error);
-      return;
     }
 
   self = GF_ICON_VIEW (user_data);
 
-  for (l = files; l != NULL; l = l->next)
+  if (files == NULL)
     {
-      GFileInfo *info;
-      GFile *file;
-      GtkWidget *icon;
-      GfIconInfo *icon_info;
-
-      info = l->data;
-      file = g_file_enumerator_get_child (enumerator, info);
-
-      icon = gf_icon_new (self, file, info);
-      g_object_unref (file);
+      g_clear_object (&self->enumerator);
 
-      g_signal_connect (icon, "changed", G_CALLBACK (icon_changed_cb), self);
+      if (self->populate_id == 0)
+        population_finished (self);
 
-      icon_info = create_icon_info (self, icon);
-      self->icons = g_list_prepend (self->icons, icon_info);
+      return;
     }
 
-  if (g_settings_get_boolean (self->settings, "show-home"))
-    append_home_icon (self);
-
-  if (g_settings_get_boolean (self->settings, "show-trash"))
-    append_trash_icon (self);
+  for (l = files; l != NULL; l = l->next)
+    g_queue_push_tail (self->pending_files, l->data);
 
-  g_list_free_full (files, g_object_unref);
+  g_list_free (files);
 
-  if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-    sort_icons (self);
+  schedule_populate (self);
+  next_files (self);
+}
 
-  add_icons (self);
+static void
+next_files (GfIconView *self)
+{
+  g_file_enumerator_next_files_async (self->enumerator,
+                                      N_FILES_PER_PAGE,
+                                      G_PRIORITY_LOW,
+                                      self->cancellable,
+                                      next_files_cb,
+                                      self);
 }
 
 static void
@@ -1748,15 +2315,32 @@ enumerate_children_cb (GObject      *object,
     }
 
   self = GF_ICON_VIEW (user_data);
+  self->enumerator = enumerator;
 
-  g_file_enumerator_next_files_async (enumerator,
-                                      G_MAXINT32,
-                                      G_PRIORITY_LOW,
-                                      self->cancellable,
-                                      next_files_cb,
-                                      user_data);
+  next_files (self);
+}
+
+static void
+load_cache_cb (GFile     *file,
+               GFileInfo *info,
+               gpointer   user_data)
+{
+  GfIconView *self;
+  GtkWidget *icon;
+  GfIconInfo *icon_info;
+
+  self = GF_ICON_VIEW (user_data);
+
+  if (find_icon_info_by_file (self, file) != NULL)
+    return;
+
+  icon = gf_icon_new (self, file, info);
+  g_signal_connect (icon, "changed", G_CALLBACK (icon_changed_cb), self);
+
+  icon_info = create_icon_info (self, icon);
+  icon_info->cached = TRUE;
 
-  g_object_unref (enumerator);
+  add_icon_info (self, icon_info);
 }
 
 static void
@@ -1764,6 +2348,19 @@ enumerate_desktop (GfIconView *self)
 {
   char *attributes;
 
+  /* Trash comes before Home, as it always has */
+  if (g_settings_get_boolean (self->settings, "show-trash"))
+    append_trash_icon (self);
+
+  if (g_settings_get_boolean (self->settings, "show-home"))
+    append_home_icon (self);
+
+  /* Icons from the cache are shown right away and reconciled with the
+   * desktop directory while it is being enumerated.
+   */
+  gf_icon_cache_load (self->icon_cache, load_cache_cb, self);
+  add_icons (self);
+
   attributes = gf_icon_view_get_file_attributes (self);
 
   g_file_enumerate_children_async (self->desktop,
@@ -1936,17 +2533,17 @@ monitor_removed_cb (GdkDisplay *display,
                     GfIconView *self)
 {
   GtkWidget *view;
-  GList *l;
+  guint i;
 
   view = find_monitor_view_by_monitor (self, monitor);
   if (view == NULL)
     return;
 
-  for (l = self->icons; l != NULL; l = l->next)
+  for (i = 0; i < self->icons->len; i++)
     {
       GfIconInfo *info;
 
-      info = (GfIconInfo *) l->data;
+      info = g_ptr_array_index (self->icons, i);
 
       if (info->view != view)
         continue;
@@ -1999,7 +2596,7 @@ placement_changed_cb (GSettings  *settings,
   if (placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
     resort_icons (self, FALSE);
   else if (placement == GF_PLACEMENT_ALIGN_ICONS_TO_GRID)
-    remove_and_readd_icons (self);
+    relayout_icons (self);
 }
 
 static void
@@ -2035,13 +2632,11 @@ show_home_changed_cb (GSettings  *settings,
   else if (self->home_info != NULL)
     {
       remove_icon_from_view (self, self->home_info);
-
-      self->icons = g_list_remove (self->icons, self->home_info);
-      gf_icon_info_free (self->home_info);
+      remove_icon_info (self, self->home_info);
       self->home_info = NULL;
 
       if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-        remove_and_readd_icons (self);
+        relayout_icons (self);
     }
 }
 
@@ -2060,13 +2655,11 @@ show_trash_changed_cb (GSettings  *settings,
   else if (self->trash_info != NULL)
     {
       remove_icon_from_view (self, self->trash_info);
-
-      self->icons = g_list_remove (self->icons, self->trash_info);
-      gf_icon_info_free (self->trash_info);
+      remove_icon_info (self, self->trash_info);
       self->trash_info = NULL;
 
       if (self->placement == GF_PLACEMENT_AUTO_ARRANGE_ICONS)
-        remove_and_readd_icons (self);
+        relayout_icons (self);
     }
 }
 
@@ -2110,7 +2703,7 @@ static void
 select_all_cb (GfIconView *self,
                gpointer    user_data)
 {
-  g_list_foreach (self->icons, select_cb, NULL);
+  g_ptr_array_foreach (self->icons, select_cb, NULL);
 }
 
 static void
@@ -2406,7 +2999,7 @@ move_cb (GfIconView       *self,
   modify = FALSE;
   view = NULL;
 
-  if (self->icons == NULL)
+  if (self->icons->len == 0)
     return;
 
   if (gtk_get_current_event_state (&state))
@@ -2430,20 +3023,12 @@ move_cb (GfIconView       *self,
 
   if (self->last_selected_icon != NULL)
     {
-      GList *l;
-
-      for (l = self->icons; l != NULL; l = l->next)
-        {
-          GfIconInfo *info;
+      GfIconInfo *info;
 
-          info = (GfIconInfo *) l->data;
+      info = find_icon_info_by_icon (self, self->last_selected_icon);
 
-          if (GF_ICON (info->icon) == self->last_selected_icon)
-            {
-              view = GF_MONITOR_VIEW (info->view);
-              break;
-            }
-        }
+      if (info != NULL)
+        view = GF_MONITOR_VIEW (info->view);
     }
   else
     {
@@ -2562,12 +3147,35 @@ gf_icon_view_dispose (GObject *object)
   g_cancellable_cancel (self->cancellable);
   g_clear_object (&self->cancellable);
 
-  if (self->icons != NULL)
+  if (self->populate_id != 0)
+    {
+      g_source_remove (self->populate_id);
+      self->populate_id = 0;
+    }
+
+  g_clear_object (&self->enumerator);
+  g_queue_clear_full (self->pending_files, g_object_unref);
+
+  if (self->save_cache_id != 0)
     {
-      g_list_free_full (self->icons, gf_icon_info_free);
-      self->icons = NULL;
+      g_source_remove (self->save_cache_id);
+      self->save_cache_id = 0;
     }
 
+  g_clear_object (&self->icon_cache);
+
+  if (self->batch_id != 0)
+    {
+      g_source_remove (self->batch_id);
+      self->batch_id = 0;
+    }
+
+  g_hash_table_remove_all (self->changed_icons);
+  g_hash_table_remove_all (self->created_files);
+
+  g_hash_table_remove_all (self->icons_by_uri);
+  g_ptr_array_set_size (self->icons, 0);
+
   g_clear_pointer (&self->selected_icons, g_list_free);
 
   g_clear_object (&self->rubberband_css);
@@ -2593,6 +3201,14 @@ gf_icon_view_finalize (GObject *object)
 
   g_clear_pointer (&self->dummy_icon, gtk_widget_unparent);
 
+  g_clear_pointer (&self->pending_files, g_queue_free);
+
+  g_clear_pointer (&self->changed_icons, g_hash_table_destroy);
+  g_clear_pointer (&self->created_files, g_hash_table_destroy);
+
+  g_clear_pointer (&self->icons_by_uri, g_hash_table_destroy);
+  g_clear_pointer (&self->icons, g_ptr_array_unref);
+
   G_OBJECT_CLASS (gf_icon_view_parent_class)->finalize (object);
 }
 
@@ -2942,6 +3558,17 @@ gf_icon_view_init (GfIconView *self)
   int n_monitors;
   int i;
 
+  self->pending_files = g_queue_new ();
+
+  self->icons = g_ptr_array_new_with_free_func (gf_icon_info_free);
+  self->icons_by_uri = g_hash_table_new (g_str_hash, g_str_equal);
+
+  self->changed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, NULL);
+
+  self->created_files = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, g_object_unref);
+
   g_signal_connect (self, "select-all", G_CALLBACK (select_all_cb), NULL);
   g_signal_connect (self, "unselect-all", G_CALLBACK (unselect_all_cb), NULL);
   g_signal_connect (self, "activate", G_CALLBACK (activate_cb), NULL);
@@ -2982,6 +3609,7 @@ gf_icon_view_init (GfIconView *self)
 
   desktop_dir = g_get_user_special_dir (G_USER_DIRECTORY_DESKTOP);
   self->desktop = g_file_new_for_path (desktop_dir);
+  self->icon_cache = gf_icon_cache_new (self->desktop);
 
   error = NULL;
   self->monitor = g_file_monitor_directory (self->desktop,
@@ -3002,6 +3630,10 @@ gf_icon_view_init (GfIconView *self)
 
   self->settings = g_settings_new ("org.gnome.gnome-flashback.desktop.icons");
 
+  g_settings_bind (self->settings, "thumbnail-workers",
+                   self->thumbnail_factory, "n-workers",
+                   G_SETTINGS_BIND_GET);
+
   g_signal_connect (self->settings, "changed::placement",
                     G_CALLBACK (placement_changed_cb),
                     self);
@@ -3210,7 +3842,7 @@ gf_icon_view_validate_new_name (GfIconView  *self,
   gboolean is_dir;
   char *text;
   gboolean valid;
-  GList *l;
+  guint i;
 
   g_assert (message != NULL && *message == NULL);
 
@@ -3250,12 +3882,12 @@ gf_icon_view_validate_new_name (GfIconView  *self,
       valid = FALSE;
     }
 
-  for (l = self->icons; l != NULL; l = l->next)
+  for (i = 0; i < self->icons->len; i++)
     {
       GfIconInfo *info;
       const char *name;
 
-      info = l->data;
+      info = g_ptr_array_index (self->icons, i);
 
       name = gf_icon_get_name (GF_ICON (info->icon));
       if (g_strcmp0 (name, text) == 0)
@@ -3369,3 +4001,15 @@ gf_icon_view_move_uris (GfIconView         *self,
                                    move_uris_cb,
                                    NULL);
 }
+
+gboolean
+gf_icon_view_is_populated (GfIconView *self)
+{
+  return self->populated;
+}
+
+guint
+gf_icon_view_get_n_icons (GfIconView *self)
+{
+  return self->icons->len;
+}
@@ -78,6 +78,10 @@ void                gf_icon_view_move_uris                (GfIconView          *
                                                            const char          *destination,
                                                            guint32              timestamp);
 
+gboolean            gf_icon_view_is_populated             (GfIconView          *self);
+
+guint               gf_icon_view_get_n_icons              (GfIconView          *self);
+
 G_END_DECLS
 
 #endif
@@ -27,6 +27,17 @@
 #include "gf-trash-icon.h"
 #include "gf-utils.h"
 
+#define THUMBNAIL_CACHE_MAX_BYTES (32 * 1024 * 1024)
+
+typedef struct
+{
+  GList            link;
+
+  char            *key;
+  cairo_surface_t *surface;
+  gsize            size;
+} GfThumbnailCacheEntry;
+
 typedef struct
 {
   GCancellable    *cancellable;
@@ -41,8 +52,6 @@ typedef struct
   GFile           *file;
   GFileInfo       *info;
 
-  GFileMonitor    *monitor;
-
   GfIconSize       icon_size;
   guint            extra_text_width;
 
@@ -61,6 +70,7 @@ typedef struct
 
   GtkWidget       *popover;
 
+  int              thumbnail_priority;
   gboolean         thumbnail_error;
   GIcon           *thumbnail;
 } GfIconPrivate;
@@ -92,8 +102,121 @@ enum
 
 static guint icon_signals[LAST_SIGNAL] = { 0 };
 
+static GHashTable *thumbnail_cache = NULL;
+static GQueue thumbnail_cache_lru = G_QUEUE_INIT;
+static gsize thumbnail_cache_size = 0;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GfIcon, gf_icon, GTK_TYPE_BUTTON)
 
+static void
+thumbnail_cache_entry_free (gpointer data)
+{
+  GfThumbnailCacheEntry *entry;
+
+  entry = data;
+
+  g_queue_unlink (&thumbnail_cache_lru, &entry->link);
+  thumbnail_cache_size -= entry->size;
+
+  cairo_surface_destroy (entry->surface);
+  g_free (entry->key);
+  g_free (entry);
+}
+
+static char *
+get_thumbnail_cache_key (GfIcon *self)
+{
+  GfIconPrivate *priv;
+  GFile *file;
+  char *path;
+  char *key;
+
+  priv = gf_icon_get_instance_private (self);
+
+  if (!G_IS_FILE_ICON (priv->thumbnail))
+    return NULL;
+
+  file = g_file_icon_get_file (G_FILE_ICON (priv->thumbnail));
+  path = g_file_get_path (file);
+
+  if (path == NULL)
+    return NULL;
+
+  /* Thumbnail path does not change when file is modified */
+  key = g_strdup_printf ("%s:%d:%d:%" G_GUINT64_FORMAT,
+                         path,
+                         priv->icon_size,
+                         gtk_widget_get_scale_factor (GTK_WIDGET (self)),
+                         gf_icon_get_time_modified (self));
+
+  g_free (path);
+
+  return key;
+}
+
+static cairo_surface_t *
+thumbnail_cache_lookup (const char *key)
+{
+  GfThumbnailCacheEntry *entry;
+
+  if (thumbnail_cache == NULL)
+    return NULL;
+
+  entry = g_hash_table_lookup (thumbnail_cache, key);
+
+  if (entry == NULL)
+    return NULL;
+
+  g_queue_unlink (&thumbnail_cache_lru, &entry->link);
+  g_queue_push_head_link (&thumbnail_cache_lru, &entry->link);
+
+  return cairo_surface_reference (entry->surface);
+}
+
+static void
+thumbnail_cache_insert (const char      *key,
+                        cairo_surface_t *surface)
+{
+  GfThumbnailCacheEntry *entry;
+  gsize size;
+
+  size = (gsize) cairo_image_surface_get_stride (surface) *
+         cairo_image_surface_get_height (surface);
+
+  if (size > THUMBNAIL_CACHE_MAX_BYTES)
+    return;
+
+  if (thumbnail_cache == NULL)
+    {
+      thumbnail_cache = g_hash_table_new_full (g_str_hash,
+                                               g_str_equal,
+                                               NULL,
+                                               thumbnail_cache_entry_free);
+    }
+
+  g_hash_table_remove (thumbnail_cache, key);
+
+  while (thumbnail_cache_size + size > THUMBNAIL_CACHE_MAX_BYTES)
+    {
+      GfThumbnailCacheEntry *oldest;
+
+      oldest = g_queue_peek_tail (&thumbnail_cache_lru);
+      g_hash_table_remove (thumbnail_cache, oldest->key);
+    }
+
+  entry = g_new0 (GfThumbnailCacheEntry, 1);
+  entry->link.data = entry;
+
+  entry->key = g_strdup (key);
+  entry->surface = cairo_surface_reference (surface);
+  entry->size = size;
+
+  g_queue_push_head_link (&thumbnail_cache_lru, &entry->link);
+  thumbnail_cache_size += size;
+
+  g_hash_table_insert (thumbnail_cache, entry->key, entry);
+}
+
 static void
 update_state (GfIcon *self)
 {
@@ -723,7 +846,7 @@ multi_press_released_cb (GtkGestureMultiPress *gesture,
 }
 
 static cairo_surface_t *
-get_thumbnail_surface (GfIcon *self)
+load_thumbnail_surface (GfIcon *self)
 {
   GfIconPrivate *priv;
   GtkIconTheme *icon_theme;
@@ -744,9 +867,6 @@ get_thumbnail_surface (GfIcon *self)
 
   priv = gf_icon_get_instance_private (self);
 
-  if (priv->thumbnail == NULL)
-    return NULL;
-
   icon_theme = gtk_icon_theme_get_default ();
   scale = gtk_widget_get_scale_factor (GTK_WIDGET (self));
   lookup_flags = GTK_ICON_LOOKUP_FORCE_SIZE;
@@ -805,6 +925,38 @@ get_thumbnail_surface (GfIcon *self)
   return thumbnail_surface;
 }
 
+static cairo_surface_t *
+get_thumbnail_surface (GfIcon *self)
+{
+  GfIconPrivate *priv;
+  char *key;
+  cairo_surface_t *surface;
+
+  priv = gf_icon_get_instance_private (self);
+
+  if (priv->thumbnail == NULL)
+    return NULL;
+
+  key = get_thumbnail_cache_key (self);
+
+  if (key == NULL)
+    return load_thumbnail_surface (self);
+
+  surface = thumbnail_cache_lookup (key);
+
+  if (surface == NULL)
+    {
+      surface = load_thumbnail_surface (self);
+
+      if (surface != NULL)
+        thumbnail_cache_insert (key, surface);
+    }
+
+  g_free (key);
+
+  return surface;
+}
+
 static void
 update_icon (GfIcon *self)
 {
@@ -859,7 +1011,20 @@ update_text (GfIcon *self)
   gtk_label_set_text (GTK_LABEL (priv->label), name);
 
   g_clear_pointer (&priv->name_collated, g_free);
-  priv->name_collated = g_utf8_collate_key_for_filename (name, -1);
+
+  if (g_file_info_has_attribute (priv->info, GF_ICON_ATTRIBUTE_NAME_COLLATED))
+    {
+      const char *name_collated;
+
+      name_collated = g_file_info_get_attribute_string (priv->info,
+                                                        GF_ICON_ATTRIBUTE_NAME_COLLATED);
+
+      priv->name_collated = g_strdup (name_collated);
+    }
+  else
+    {
+      priv->name_collated = g_utf8_collate_key_for_filename (name, -1);
+    }
 
   if (g_strcmp0 (old_name, name) != 0)
     {
@@ -894,6 +1059,8 @@ thumbnail_ready_cb (GObject      *object,
   self = GF_ICON (user_data);
   priv = gf_icon_get_instance_private (self);
 
+  g_clear_object (&priv->thumbnail_cancellable);
+
   if (error != NULL)
     {
       priv->thumbnail_error = TRUE;
@@ -936,10 +1103,17 @@ load_thumbnail (GfIcon *self)
 
   priv->thumbnail_cancellable = g_cancellable_new ();
 
+  /* Thumbnails for icons that are on screen are loaded first */
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)))
+    priv->thumbnail_priority = G_PRIORITY_DEFAULT;
+  else
+    priv->thumbnail_priority = G_PRIORITY_LOW;
+
   gf_thumbnail_factory_load_async (factory,
                                    uri,
                                    content_type,
                                    time_modified,
+                                   priv->thumbnail_priority,
                                    priv->thumbnail_cancellable,
                                    thumbnail_ready_cb,
                                    self);
@@ -1035,56 +1209,6 @@ set_icon_size (GfIcon *self,
   update_icon (self);
 }
 
-static void
-file_changed_cb (GFileMonitor      *monitor,
-                 GFile             *file,
-                 GFile             *other_file,
-                 GFileMonitorEvent  event_type,
-                 GfIcon            *self)
-{
-  switch (event_type)
-    {
-      case G_FILE_MONITOR_EVENT_CHANGED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
-        if (icon_refresh (self))
-          g_signal_emit (self, icon_signals[CHANGED], 0);
-        break;
-
-      case G_FILE_MONITOR_EVENT_DELETED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_CREATED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
-        gf_icon_update (self);
-        break;
-
-      case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
-        break;
-
-      case G_FILE_MONITOR_EVENT_UNMOUNTED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_MOVED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_RENAMED:
-        break;
-
-      case G_FILE_MONITOR_EVENT_MOVED_IN:
-        break;
-
-      case G_FILE_MONITOR_EVENT_MOVED_OUT:
-        break;
-
-      default:
-        break;
-    }
-}
-
 static void
 set_file (GfIcon *self,
           GFile  *file)
@@ -1096,7 +1220,8 @@ set_file (GfIcon *self,
   g_clear_object (&priv->file);
   priv->file = g_object_ref (file);
 
-  GF_ICON_GET_CLASS (self)->create_file_monitor (self);
+  if (GF_ICON_GET_CLASS (self)->create_file_monitor != NULL)
+    GF_ICON_GET_CLASS (self)->create_file_monitor (self);
 }
 
 static void
@@ -1126,8 +1251,6 @@ gf_icon_dispose (GObject *object)
   g_clear_object (&priv->file);
   g_clear_object (&priv->info);
 
-  g_clear_object (&priv->monitor);
-
   g_clear_object (&priv->app_info);
 
   g_clear_object (&priv->thumbnail);
@@ -1247,32 +1370,19 @@ gf_icon_get_preferred_width (GtkWidget *widget,
 }
 
 static void
-gf_icon_create_file_monitor (GfIcon *self)
+gf_icon_map (GtkWidget *widget)
 {
+  GfIcon *self;
   GfIconPrivate *priv;
-  GError *error;
 
+  self = GF_ICON (widget);
   priv = gf_icon_get_instance_private (self);
 
-  g_clear_object (&priv->monitor);
-
-  error = NULL;
-  priv->monitor = g_file_monitor_file (priv->file,
-                                       G_FILE_MONITOR_NONE,
-                                       NULL,
-                                       &error);
+  GTK_WIDGET_CLASS (gf_icon_parent_class)->map (widget);
 
-  if (error != NULL)
-    {
-      g_warning ("%s", error->message);
-      g_error_free (error);
-      return;
-    }
-
-  g_signal_connect (priv->monitor,
-                    "changed",
-                    G_CALLBACK (file_changed_cb),
-                    self);
+  if (priv->thumbnail_cancellable != NULL &&
+      priv->thumbnail_priority != G_PRIORITY_DEFAULT)
+    load_thumbnail (self);
 }
 
 static GIcon *
@@ -1285,6 +1395,24 @@ gf_icon_get_icon (GfIcon   *self,
   priv = gf_icon_get_instance_private (self);
   icon = NULL;
 
+  if (priv->thumbnail == NULL && !priv->thumbnail_error &&
+      g_file_info_has_attribute (priv->info, GF_ICON_ATTRIBUTE_THUMBNAIL_PATH))
+    {
+      const char *path;
+
+      path = g_file_info_get_attribute_byte_string (priv->info,
+                                                    GF_ICON_ATTRIBUTE_THUMBNAIL_PATH);
+
+      if (g_file_test (path, G_FILE_TEST_IS_REGULAR))
+        {
+          GFile *file;
+
+          file = g_file_new_for_path (path);
+          priv->thumbnail = g_file_icon_new (file);
+          g_object_unref (file);
+        }
+    }
+
   if (priv->thumbnail != NULL)
     {
       *is_thumbnail = TRUE;
@@ -1423,8 +1551,8 @@ gf_icon_class_init (GfIconClass *self_class)
   object_class->set_property = gf_icon_set_property;
 
   widget_class->get_preferred_width = gf_icon_get_preferred_width;
+  widget_class->map = gf_icon_map;
 
-  self_class->create_file_monitor = gf_icon_create_file_monitor;
   self_class->get_icon = gf_icon_get_icon;
   self_class->get_text = gf_icon_get_text;
   self_class->can_delete = gf_icon_can_delete;
@@ -1556,6 +1684,25 @@ gf_icon_get_file (GfIcon *self)
   return priv->file;
 }
 
+void
+gf_icon_set_file_info (GfIcon    *self,
+                       GFileInfo *info)
+{
+  GfIconPrivate *priv;
+
+  priv = gf_icon_get_instance_private (self);
+
+  /* A pending query would replace the newer info */
+  g_cancellable_cancel (priv->cancellable);
+  g_clear_object (&priv->cancellable);
+
+  g_set_object (&priv->info, info);
+
+  icon_refresh (self);
+
+  g_signal_emit (self, icon_signals[CHANGED], 0);
+}
+
 GFileInfo *
 gf_icon_get_file_info (GfIcon *self)
 {
@@ -1642,6 +1789,19 @@ gf_icon_is_hidden (GfIcon *self)
   return hidden || backup;
 }
 
+GFile *
+gf_icon_get_thumbnail (GfIcon *self)
+{
+  GfIconPrivate *priv;
+
+  priv = gf_icon_get_instance_private (self);
+
+  if (priv->thumbnail == NULL || !G_IS_FILE_ICON (priv->thumbnail))
+    return NULL;
+
+  return g_file_icon_get_file (G_FILE_ICON (priv->thumbnail));
+}
+
 void
 gf_icon_set_selected (GfIcon   *self,
                       gboolean  selected)
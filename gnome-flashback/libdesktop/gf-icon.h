@@ -22,6 +22,9 @@
 
 G_BEGIN_DECLS
 
+#define GF_ICON_ATTRIBUTE_NAME_COLLATED "gf::name-collated"
+#define GF_ICON_ATTRIBUTE_THUMBNAIL_PATH "gf::thumbnail-path"
+
 #define GF_TYPE_ICON (gf_icon_get_type ())
 G_DECLARE_DERIVABLE_TYPE (GfIcon, gf_icon, GF, ICON, GtkButton)
 
@@ -56,6 +59,9 @@ void        gf_icon_set_file          (GfIcon     *self,
 
 GFile      *gf_icon_get_file          (GfIcon     *self);
 
+void        gf_icon_set_file_info     (GfIcon     *self,
+                                       GFileInfo  *info);
+
 GFileInfo  *gf_icon_get_file_info     (GfIcon     *self);
 
 const char *gf_icon_get_name          (GfIcon     *self);
@@ -70,6 +76,8 @@ guint64     gf_icon_get_size          (GfIcon     *self);
 
 gboolean    gf_icon_is_hidden         (GfIcon     *self);
 
+GFile      *gf_icon_get_thumbnail     (GfIcon     *self);
+
 void        gf_icon_set_selected      (GfIcon     *self,
                                        gboolean    selected);
 
@@ -23,6 +23,8 @@
 #include "gf-icon.h"
 #include "gf-utils.h"
 
+#define BITS_PER_WORD (GLIB_SIZEOF_LONG * 8)
+
 struct _GfMonitorView
 {
   GtkFixed     parent;
@@ -59,6 +61,11 @@ struct _GfMonitorView
   int          offset_y;
 
   GHashTable  *grid;
+  GHashTable  *icon_cells;
+
+  gulong      *occupied;
+  int          n_cells;
+  int          free_cell;
 
   gboolean     drop_pending;
 };
@@ -93,30 +100,93 @@ static guint view_signals[LAST_SIGNAL] = { 0 };
 
 G_DEFINE_TYPE (GfMonitorView, gf_monitor_view, GTK_TYPE_FIXED)
 
-static GfIcon *
-find_first_icon (GfMonitorView *self)
+static int
+get_n_words (GfMonitorView *self)
 {
-  int column;
-  int row;
+  return (self->n_cells + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+static void
+reset_occupancy (GfMonitorView *self)
+{
+  g_clear_pointer (&self->occupied, g_free);
+
+  self->n_cells = MAX (self->columns * self->rows, 0);
+  self->occupied = g_new0 (gulong, MAX (get_n_words (self), 1));
+  self->free_cell = 0;
+
+  g_hash_table_remove_all (self->icon_cells);
+}
+
+static void
+set_cell_occupied (GfMonitorView *self,
+                   int            cell,
+                   gboolean       occupied)
+{
+  gulong mask;
+
+  mask = 1UL << (cell % BITS_PER_WORD);
 
-  for (column = 0; column < self->columns; column++)
+  if (occupied)
     {
-      for (row = 0; row < self->rows; row++)
-        {
-          gpointer key;
-          GPtrArray *array;
+      self->occupied[cell / BITS_PER_WORD] |= mask;
+    }
+  else
+    {
+      self->occupied[cell / BITS_PER_WORD] &= ~mask;
+      self->free_cell = MIN (self->free_cell, cell);
+    }
+}
 
-          key = GINT_TO_POINTER (column * self->rows + row);
-          array = g_hash_table_lookup (self->grid, key);
+static int
+find_cell (GfMonitorView *self,
+           int            start_cell,
+           gboolean       occupied)
+{
+  int n_words;
+  int word;
 
-          if (array == NULL || array->len == 0)
-            continue;
+  n_words = get_n_words (self);
 
-          return array->pdata[0];
-        }
+  for (word = start_cell / BITS_PER_WORD; word < n_words; word++)
+    {
+      gulong bits;
+      int cell;
+
+      bits = occupied ? self->occupied[word] : ~self->occupied[word];
+
+      if (word == start_cell / BITS_PER_WORD)
+        bits &= ~0UL << (start_cell % BITS_PER_WORD);
+
+      if (bits == 0)
+        continue;
+
+      cell = word * BITS_PER_WORD + g_bit_nth_lsf (bits, -1);
+
+      if (cell >= self->n_cells)
+        break;
+
+      return cell;
     }
 
-  return NULL;
+  return -1;
+}
+
+static GfIcon *
+find_first_icon (GfMonitorView *self)
+{
+  int cell;
+  GPtrArray *array;
+
+  cell = find_cell (self, 0, TRUE);
+  if (cell == -1)
+    return NULL;
+
+  array = g_hash_table_lookup (self->grid, GINT_TO_POINTER (cell));
+  if (array == NULL || array->len == 0)
+    return NULL;
+
+  return array->pdata[0];
 }
 
 static gboolean
@@ -125,33 +195,18 @@ find_icon_grid_position (GfMonitorView *self,
                          int           *column_out,
                          int           *row_out)
 {
-  int column;
-  int row;
-
-  for (column = 0; column < self->columns; column++)
-    {
-      for (row = 0; row < self->rows; row++)
-        {
-          gpointer key;
-          GPtrArray *array;
+  gpointer value;
+  int cell;
 
-          key = GINT_TO_POINTER (column * self->rows + row);
-          array = g_hash_table_lookup (self->grid, key);
+  if (!g_hash_table_lookup_extended (self->icon_cells, icon, NULL, &value))
+    return FALSE;
 
-          if (array == NULL || array->len == 0)
-            continue;
+  cell = GPOINTER_TO_INT (value);
 
-          if (g_ptr_array_find (array, icon, NULL))
-            {
-              *column_out = column;
-              *row_out = row;
+  *column_out = cell / self->rows;
+  *row_out = cell % self->rows;
 
-              return TRUE;
-            }
-        }
-    }
-
-  return FALSE;
+  return TRUE;
 }
 
 static GfIcon *
@@ -296,30 +351,76 @@ find_free_grid_position (GfMonitorView *self,
                          int           *column_out,
                          int           *row_out)
 {
-  int column;
-  int row;
+  int cell;
 
-  for (column = 0; column < self->columns; column++)
+  cell = find_cell (self, self->free_cell, FALSE);
+
+  if (cell == -1)
     {
-      for (row = 0; row < self->rows; row++)
-        {
-          gpointer key;
-          GPtrArray *array;
+      self->free_cell = self->n_cells;
+      return FALSE;
+    }
 
-          key = GINT_TO_POINTER (column * self->rows + row);
-          array = g_hash_table_lookup (self->grid, key);
+  self->free_cell = cell;
 
-          if (array == NULL || array->len == 0)
-            {
-              *column_out = column;
-              *row_out = row;
+  *column_out = cell / self->rows;
+  *row_out = cell % self->rows;
 
-              return TRUE;
-            }
-        }
+  return TRUE;
+}
+
+static void
+remove_icon_from_cell (GfMonitorView *self,
+                       GtkWidget     *icon)
+{
+  gpointer key;
+  GPtrArray *array;
+
+  if (!g_hash_table_lookup_extended (self->icon_cells, icon, NULL, &key))
+    return;
+
+  array = g_hash_table_lookup (self->grid, key);
+
+  if (array != NULL)
+    g_ptr_array_remove (array, icon);
+
+  if (array == NULL || array->len == 0)
+    set_cell_occupied (self, GPOINTER_TO_INT (key), FALSE);
+
+  g_hash_table_remove (self->icon_cells, icon);
+}
+
+static void
+add_icon_to_cell (GfMonitorView *self,
+                  GtkWidget     *icon,
+                  int            cell)
+{
+  gpointer key;
+  GPtrArray *array;
+
+  key = GINT_TO_POINTER (cell);
+  array = g_hash_table_lookup (self->grid, key);
+
+  if (array == NULL)
+    {
+      array = g_ptr_array_new ();
+      g_hash_table_insert (self->grid, key, array);
     }
 
-  return FALSE;
+  g_ptr_array_add (array, icon);
+
+  g_hash_table_insert (self->icon_cells, icon, key);
+  set_cell_occupied (self, cell, TRUE);
+}
+
+static void
+get_cell_position (GfMonitorView *self,
+                   int            cell,
+                   int           *x,
+                   int           *y)
+{
+  *x = self->offset_x + (cell / self->rows) * self->spacing_x;
+  *y = self->offset_y + (cell % self->rows) * self->spacing_y;
 }
 
 static void
@@ -863,6 +964,7 @@ calculate_grid_size (GfMonitorView *self)
     return;
 
   g_hash_table_remove_all (self->grid);
+  reset_occupancy (self);
 
   g_signal_emit (self, view_signals[SIZE_CHANGED], 0);
 
@@ -973,6 +1075,8 @@ gf_monitor_view_finalize (GObject *object)
   self = GF_MONITOR_VIEW (object);
 
   g_clear_pointer (&self->grid, g_hash_table_destroy);
+  g_clear_pointer (&self->icon_cells, g_hash_table_destroy);
+  g_clear_pointer (&self->occupied, g_free);
 
   G_OBJECT_CLASS (gf_monitor_view_parent_class)->finalize (object);
 }
@@ -1218,6 +1322,9 @@ gf_monitor_view_init (GfMonitorView *self)
   self->grid = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
                                       (GDestroyNotify) g_ptr_array_unref);
 
+  self->icon_cells = g_hash_table_new (g_direct_hash, g_direct_equal);
+  reset_occupancy (self);
+
   setup_drop_destination (self);
 }
 
@@ -1277,27 +1384,19 @@ gf_monitor_view_add_icon (GfMonitorView *self,
 {
   int column;
   int row;
-  gpointer key;
-  GPtrArray *array;
+  int cell;
   int x;
   int y;
 
   if (!find_free_grid_position (self, &column, &row))
     return FALSE;
 
-  key = GINT_TO_POINTER (column * self->rows + row);
-  array = g_hash_table_lookup (self->grid, key);
+  cell = column * self->rows + row;
 
-  if (array == NULL)
-    {
-      array = g_ptr_array_new ();
-      g_hash_table_insert (self->grid, key, array);
-    }
+  add_icon_to_cell (self, icon, cell);
+  self->free_cell = cell + 1;
 
-  g_ptr_array_add (array, icon);
-
-  x = self->offset_x + column * self->spacing_x;
-  y = self->offset_y + row * self->spacing_y;
+  get_cell_position (self, cell, &x, &y);
 
   gtk_fixed_put (GTK_FIXED (self), icon, x, y);
   gtk_widget_show (icon);
@@ -1305,29 +1404,49 @@ gf_monitor_view_add_icon (GfMonitorView *self,
   return TRUE;
 }
 
+int
+gf_monitor_view_get_n_cells (GfMonitorView *self)
+{
+  return self->n_cells;
+}
+
 void
-gf_monitor_view_remove_icon (GfMonitorView *self,
-                             GtkWidget     *icon)
+gf_monitor_view_place_icon (GfMonitorView *self,
+                            GtkWidget     *icon,
+                            int            cell)
 {
-  int column;
-  int row;
+  gpointer key;
+  int x;
+  int y;
+
+  g_return_if_fail (cell >= 0 && cell < self->n_cells);
+
+  get_cell_position (self, cell, &x, &y);
 
-  for (column = 0; column < self->columns; column++)
+  if (g_hash_table_lookup_extended (self->icon_cells, icon, NULL, &key))
     {
-      for (row = 0; row < self->rows; row++)
-        {
-          gpointer key;
-          GPtrArray *array;
+      if (GPOINTER_TO_INT (key) == cell)
+        return;
 
-          key = GINT_TO_POINTER (column * self->rows + row);
-          array = g_hash_table_lookup (self->grid, key);
+      remove_icon_from_cell (self, icon);
+      add_icon_to_cell (self, icon, cell);
 
-          if (array == NULL || array->len == 0)
-            continue;
+      gtk_fixed_move (GTK_FIXED (self), icon, x, y);
+    }
+  else
+    {
+      add_icon_to_cell (self, icon, cell);
 
-          g_ptr_array_remove (array, icon);
-        }
+      gtk_fixed_put (GTK_FIXED (self), icon, x, y);
+      gtk_widget_show (icon);
     }
+}
+
+void
+gf_monitor_view_remove_icon (GfMonitorView *self,
+                             GtkWidget     *icon)
+{
+  remove_icon_from_cell (self, icon);
 
   gtk_container_remove (GTK_CONTAINER (self), icon);
   gtk_widget_hide (icon);
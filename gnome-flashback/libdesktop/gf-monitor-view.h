@@ -46,6 +46,12 @@ gboolean    gf_monitor_view_is_primary     (GfMonitorView    *self);
 gboolean    gf_monitor_view_add_icon       (GfMonitorView    *self,
                                             GtkWidget        *icon);
 
+int         gf_monitor_view_get_n_cells    (GfMonitorView    *self);
+
+void        gf_monitor_view_place_icon     (GfMonitorView    *self,
+                                            GtkWidget        *icon,
+                                            int               cell);
+
 void        gf_monitor_view_remove_icon    (GfMonitorView    *self,
                                             GtkWidget        *icon);
 
@@ -20,137 +20,328 @@
 
 #include <libgnome-desktop/gnome-desktop-thumbnail.h>
 
+#define DEFAULT_MAX_WORKERS 4
+
 typedef struct
 {
   GfThumbnailFactory *self;
 
+  char               *key;
   char               *uri;
   char               *content_type;
   guint64             time_modified;
-} GfLoadData;
+  int                 io_priority;
+  guint               sequence;
+
+  /* Protected by the factory lock, the worker checks if all tasks have
+   * been cancelled before doing anything.
+   */
+  GList              *tasks;
+
+  GIcon              *icon;
+  GError             *error;
+} GfThumbnailRequest;
 
 struct _GfThumbnailFactory
 {
   GObject                       parent;
 
   GnomeDesktopThumbnailFactory *factory;
+
+  guint                         n_workers;
+  GThreadPool                  *pool;
+
+  GMutex                        lock;
+  GHashTable                   *requests;
+  guint                         sequence;
+
+  GMainContext                 *context;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_N_WORKERS,
+
+  LAST_PROP
 };
 
+static GParamSpec *factory_properties[LAST_PROP] = { NULL };
+
 G_DEFINE_QUARK (gf-thumbnail-error-quark, gf_thumbnail_error)
 
 G_DEFINE_TYPE (GfThumbnailFactory, gf_thumbnail_factory, G_TYPE_OBJECT)
 
-static GfLoadData *
-gf_load_data_new (GfThumbnailFactory *self,
-                  const char         *uri,
-                  const char         *content_type,
-                  guint64             time_modified)
+static char *
+get_request_key (const char *uri,
+                 guint64     time_modified)
 {
-  GfLoadData *data;
+  return g_strdup_printf ("%s\n%" G_GUINT64_FORMAT, uri, time_modified);
+}
 
-  data = g_new0 (GfLoadData, 1);
-  data->self = g_object_ref (self);
+static GfThumbnailRequest *
+gf_thumbnail_request_new (GfThumbnailFactory *self,
+                          const char         *key,
+                          const char         *uri,
+                          const char         *content_type,
+                          guint64             time_modified,
+                          int                 io_priority)
+{
+  GfThumbnailRequest *request;
 
-  data->uri = g_strdup (uri);
-  data->content_type = g_strdup (content_type);
-  data->time_modified = time_modified;
+  request = g_new0 (GfThumbnailRequest, 1);
+  request->self = g_object_ref (self);
 
-  return data;
+  request->key = g_strdup (key);
+  request->uri = g_strdup (uri);
+  request->content_type = g_strdup (content_type);
+  request->time_modified = time_modified;
+  request->io_priority = io_priority;
+  request->sequence = self->sequence++;
+
+  return request;
 }
 
 static void
-gf_load_data_free (gpointer data)
+gf_thumbnail_request_free (GfThumbnailRequest *request)
 {
-  GfLoadData *load_data;
+  g_assert (request->tasks == NULL);
+
+  g_object_unref (request->self);
+  g_free (request->key);
+  g_free (request->uri);
+  g_free (request->content_type);
+  g_clear_object (&request->icon);
+  g_clear_error (&request->error);
+  g_free (request);
+}
 
-  load_data = data;
+static gboolean
+has_pending_tasks (GfThumbnailRequest *request)
+{
+  GList *l;
 
-  g_object_unref (load_data->self);
-  g_free (load_data->uri);
-  g_free (load_data->content_type);
-  g_free (load_data);
+  for (l = request->tasks; l != NULL; l = l->next)
+    {
+      GCancellable *cancellable;
+
+      cancellable = g_task_get_cancellable (l->data);
+
+      if (!g_cancellable_is_cancelled (cancellable))
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
-static void
-load_icon_in_thread (GTask        *task,
-                     gpointer      source_object,
-                     gpointer      task_data,
-                     GCancellable *cancellable)
+static gboolean
+is_request_cancelled (GfThumbnailRequest *request)
+{
+  gboolean cancelled;
+
+  g_mutex_lock (&request->self->lock);
+  cancelled = !has_pending_tasks (request);
+  g_mutex_unlock (&request->self->lock);
+
+  return cancelled;
+}
+
+static GIcon *
+load_icon (GfThumbnailFactory  *self,
+           GfThumbnailRequest  *request,
+           GError             **error)
 {
-  GfLoadData *data;
   char *path;
   GdkPixbuf *pixbuf;
 
-  data = g_task_get_task_data (task);
-
-  if (!gnome_desktop_thumbnail_factory_can_thumbnail (data->self->factory,
-                                                      data->uri,
-                                                      data->content_type,
-                                                      data->time_modified))
+  if (!gnome_desktop_thumbnail_factory_can_thumbnail (self->factory,
+                                                      request->uri,
+                                                      request->content_type,
+                                                      request->time_modified))
     {
-      g_task_return_new_error (task,
-                               GF_THUMBNAIL_ERROR,
-                               GF_THUMBNAIL_ERROR_CAN_NOT_THUMBNAIL,
-                               "Can not thumbnail this file");
-      return;
+      g_set_error (error,
+                   GF_THUMBNAIL_ERROR,
+                   GF_THUMBNAIL_ERROR_CAN_NOT_THUMBNAIL,
+                   "Can not thumbnail this file");
+      return NULL;
     }
 
-  path = gnome_desktop_thumbnail_factory_lookup (data->self->factory,
-                                                 data->uri,
-                                                 data->time_modified);
+  path = gnome_desktop_thumbnail_factory_lookup (self->factory,
+                                                 request->uri,
+                                                 request->time_modified);
 
   if (path != NULL)
     {
       GFile *file;
+      GIcon *icon;
 
       file = g_file_new_for_path (path);
       g_free (path);
 
-      g_task_return_pointer (task, g_file_icon_new (file), g_object_unref);
+      icon = g_file_icon_new (file);
       g_object_unref (file);
-      return;
+
+      return icon;
     }
 
-  if (gnome_desktop_thumbnail_factory_has_valid_failed_thumbnail (data->self->factory,
-                                                                  data->uri,
-                                                                  data->time_modified))
+  if (gnome_desktop_thumbnail_factory_has_valid_failed_thumbnail (self->factory,
+                                                                  request->uri,
+                                                                  request->time_modified))
     {
-      g_task_return_new_error (task,
-                               GF_THUMBNAIL_ERROR,
-                               GF_THUMBNAIL_ERROR_HAS_FAILED_THUMBNAIL,
-                               "File has valid failed thumbnail");
-      return;
+      g_set_error (error,
+                   GF_THUMBNAIL_ERROR,
+                   GF_THUMBNAIL_ERROR_HAS_FAILED_THUMBNAIL,
+                   "File has valid failed thumbnail");
+      return NULL;
     }
 
-  pixbuf = gnome_desktop_thumbnail_factory_generate_thumbnail (data->self->factory,
-                                                               data->uri,
-                                                               data->content_type,
+  pixbuf = gnome_desktop_thumbnail_factory_generate_thumbnail (self->factory,
+                                                               request->uri,
+                                                               request->content_type,
                                                                NULL,
                                                                NULL);
 
   if (pixbuf != NULL)
     {
-      gnome_desktop_thumbnail_factory_save_thumbnail (data->self->factory,
+      gnome_desktop_thumbnail_factory_save_thumbnail (self->factory,
                                                       pixbuf,
-                                                      data->uri,
-                                                      data->time_modified,
+                                                      request->uri,
+                                                      request->time_modified,
                                                       NULL,
                                                       NULL);
 
-      g_task_return_pointer (task, pixbuf, g_object_unref);
-      return;
+      return G_ICON (pixbuf);
     }
 
-  gnome_desktop_thumbnail_factory_create_failed_thumbnail (data->self->factory,
-                                                           data->uri,
-                                                           data->time_modified,
+  gnome_desktop_thumbnail_factory_create_failed_thumbnail (self->factory,
+                                                           request->uri,
+                                                           request->time_modified,
                                                            NULL,
                                                            NULL);
 
-  g_task_return_new_error (task,
-                           GF_THUMBNAIL_ERROR,
-                           GF_THUMBNAIL_ERROR_GENERATION_FAILED,
-                           "Thumbnail generation failed");
+  g_set_error (error,
+               GF_THUMBNAIL_ERROR,
+               GF_THUMBNAIL_ERROR_GENERATION_FAILED,
+               "Thumbnail generation failed");
+
+  return NULL;
+}
+
+static gboolean
+request_done_cb (gpointer user_data)
+{
+  GfThumbnailRequest *request;
+  GfThumbnailFactory *self;
+  GList *tasks;
+  GList *l;
+
+  request = user_data;
+  self = request->self;
+
+  g_mutex_lock (&self->lock);
+
+  /* A new task might have been added after the request was skipped */
+  if (request->icon == NULL &&
+      request->error == NULL &&
+      has_pending_tasks (request))
+    {
+      g_mutex_unlock (&self->lock);
+      g_thread_pool_push (self->pool, request, NULL);
+
+      return G_SOURCE_REMOVE;
+    }
+
+  g_hash_table_remove (self->requests, request->key);
+
+  tasks = request->tasks;
+  request->tasks = NULL;
+
+  g_mutex_unlock (&self->lock);
+
+  for (l = tasks; l != NULL; l = l->next)
+    {
+      GTask *task;
+
+      task = l->data;
+
+      if (g_task_return_error_if_cancelled (task))
+        continue;
+
+      if (request->error != NULL)
+        g_task_return_error (task, g_error_copy (request->error));
+      else
+        g_task_return_pointer (task, g_object_ref (request->icon), g_object_unref);
+    }
+
+  g_list_free_full (tasks, g_object_unref);
+  gf_thumbnail_request_free (request);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+worker_func (gpointer data,
+             gpointer user_data)
+{
+  GfThumbnailRequest *request;
+  GfThumbnailFactory *self;
+
+  request = data;
+  self = user_data;
+
+  /* Requests for icons that have been removed are skipped */
+  if (!is_request_cancelled (request))
+    request->icon = load_icon (self, request, &request->error);
+
+  g_main_context_invoke (self->context, request_done_cb, request);
+}
+
+static int
+compare_requests (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  const GfThumbnailRequest *request_a;
+  const GfThumbnailRequest *request_b;
+
+  request_a = a;
+  request_b = b;
+
+  if (request_a->io_priority != request_b->io_priority)
+    return request_a->io_priority < request_b->io_priority ? -1 : 1;
+
+  if (request_a->sequence != request_b->sequence)
+    return request_a->sequence < request_b->sequence ? -1 : 1;
+
+  return 0;
+}
+
+static guint
+get_max_workers (GfThumbnailFactory *self)
+{
+  if (self->n_workers != 0)
+    return self->n_workers;
+
+  return CLAMP (g_get_num_processors () / 2, 1, DEFAULT_MAX_WORKERS);
+}
+
+static void
+set_n_workers (GfThumbnailFactory *self,
+               guint               n_workers)
+{
+  GError *error;
+
+  self->n_workers = n_workers;
+
+  error = NULL;
+  g_thread_pool_set_max_threads (self->pool, get_max_workers (self), &error);
+
+  if (error != NULL)
+    {
+      g_warning ("%s", error->message);
+      g_error_free (error);
+    }
 }
 
 static void
@@ -160,11 +351,91 @@ gf_thumbnail_factory_dispose (GObject *object)
 
   self = GF_THUMBNAIL_FACTORY (object);
 
+  if (self->pool != NULL)
+    {
+      g_thread_pool_free (self->pool, FALSE, TRUE);
+      self->pool = NULL;
+    }
+
   g_clear_object (&self->factory);
 
   G_OBJECT_CLASS (gf_thumbnail_factory_parent_class)->dispose (object);
 }
 
+static void
+gf_thumbnail_factory_finalize (GObject *object)
+{
+  GfThumbnailFactory *self;
+
+  self = GF_THUMBNAIL_FACTORY (object);
+
+  g_clear_pointer (&self->requests, g_hash_table_destroy);
+  g_clear_pointer (&self->context, g_main_context_unref);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gf_thumbnail_factory_parent_class)->finalize (object);
+}
+
+static void
+gf_thumbnail_factory_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  GfThumbnailFactory *self;
+
+  self = GF_THUMBNAIL_FACTORY (object);
+
+  switch (property_id)
+    {
+      case PROP_N_WORKERS:
+        g_value_set_uint (value, self->n_workers);
+        break;
+
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+        break;
+    }
+}
+
+static void
+gf_thumbnail_factory_set_property (GObject      *object,
+                                   guint         property_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  GfThumbnailFactory *self;
+
+  self = GF_THUMBNAIL_FACTORY (object);
+
+  switch (property_id)
+    {
+      case PROP_N_WORKERS:
+        set_n_workers (self, g_value_get_uint (value));
+        break;
+
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+        break;
+    }
+}
+
+static void
+install_properties (GObjectClass *object_class)
+{
+  factory_properties[PROP_N_WORKERS] =
+    g_param_spec_uint ("n-workers",
+                       "n-workers",
+                       "n-workers",
+                       0, 16, 0,
+                       G_PARAM_READWRITE |
+                       G_PARAM_EXPLICIT_NOTIFY |
+                       G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, LAST_PROP,
+                                     factory_properties);
+}
+
 static void
 gf_thumbnail_factory_class_init (GfThumbnailFactoryClass *self_class)
 {
@@ -173,6 +444,11 @@ gf_thumbnail_factory_class_init (GfThumbnailFactoryClass *self_class)
   object_class = G_OBJECT_CLASS (self_class);
 
   object_class->dispose = gf_thumbnail_factory_dispose;
+  object_class->finalize = gf_thumbnail_factory_finalize;
+  object_class->get_property = gf_thumbnail_factory_get_property;
+  object_class->set_property = gf_thumbnail_factory_set_property;
+
+  install_properties (object_class);
 }
 
 static void
@@ -182,6 +458,19 @@ gf_thumbnail_factory_init (GfThumbnailFactory *self)
 
   thumbnail_size = GNOME_DESKTOP_THUMBNAIL_SIZE_LARGE;
   self->factory = gnome_desktop_thumbnail_factory_new (thumbnail_size);
+
+  g_mutex_init (&self->lock);
+  self->requests = g_hash_table_new (g_str_hash, g_str_equal);
+
+  self->context = g_main_context_ref_thread_default ();
+
+  self->pool = g_thread_pool_new (worker_func,
+                                  self,
+                                  get_max_workers (self),
+                                  FALSE,
+                                  NULL);
+
+  g_thread_pool_set_sort_function (self->pool, compare_requests, NULL);
 }
 
 GfThumbnailFactory *
@@ -196,20 +485,56 @@ gf_thumbnail_factory_load_async (GfThumbnailFactory  *self,
                                  const char          *uri,
                                  const char          *content_type,
                                  guint64              time_modified,
+                                 int                  io_priority,
                                  GCancellable        *cancellable,
                                  GAsyncReadyCallback  callback,
                                  gpointer             user_data)
 {
   GTask *task;
-  GfLoadData *data;
+  char *key;
+  GfThumbnailRequest *request;
 
   task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_priority (task, io_priority);
+
+  key = get_request_key (uri, time_modified);
+
+  g_mutex_lock (&self->lock);
+
+  /* Requests for the same file are shared, only one worker loads or
+   * generates the thumbnail.
+   */
+  request = g_hash_table_lookup (self->requests, key);
+
+  if (request != NULL)
+    {
+      request->tasks = g_list_prepend (request->tasks, task);
+
+      if (io_priority < request->io_priority)
+        {
+          request->io_priority = io_priority;
+          g_thread_pool_move_to_front (self->pool, request);
+        }
+
+      g_mutex_unlock (&self->lock);
+      g_free (key);
+      return;
+    }
+
+  request = gf_thumbnail_request_new (self,
+                                      key,
+                                      uri,
+                                      content_type,
+                                      time_modified,
+                                      io_priority);
+
+  request->tasks = g_list_prepend (request->tasks, task);
+  g_hash_table_insert (self->requests, request->key, request);
 
-  data = gf_load_data_new (self, uri, content_type, time_modified);
-  g_task_set_task_data (task, data, gf_load_data_free);
+  g_mutex_unlock (&self->lock);
+  g_free (key);
 
-  g_task_run_in_thread (task, load_icon_in_thread);
-  g_object_unref (task);
+  g_thread_pool_push (self->pool, request, NULL);
 }
 
 GIcon *
@@ -42,6 +42,7 @@ void                gf_thumbnail_factory_load_async  (GfThumbnailFactory   *self
                                                       const char           *uri,
                                                       const char           *content_type,
                                                       guint64               time_modified,
+                                                      int                   io_priority,
                                                       GCancellable         *cancellable,
                                                       GAsyncReadyCallback   callback,
                                                       gpointer              user_data);
@@ -1263,8 +1263,7 @@ update_device_display (GfInputSettings *settings,
 }
 
 static void
-monitors_changed_cb (GfMonitorManager *monitor_manager,
-                     GfInputSettings  *settings)
+update_mappable_devices (GfInputSettings *settings)
 {
   GHashTableIter iter;
   gpointer key;
@@ -1284,6 +1283,18 @@ monitors_changed_cb (GfMonitorManager *monitor_manager,
     }
 }
 
+static void
+monitor_changes_cb (GfMonitorManager        *monitor_manager,
+                    const GfMonitorsChanges *changes,
+                    GfInputSettings         *settings)
+{
+  /* Remapping every device is expensive, skip rebuilds that moved nothing */
+  if (gf_monitors_changes_is_empty (changes))
+    return;
+
+  update_mappable_devices (settings);
+}
+
 static GSettings *
 lookup_device_settings (GdkDevice *device)
 {
@@ -1588,8 +1599,8 @@ gf_input_settings_set_monitor_manager (GfInputSettings  *settings,
   settings->monitor_manager = monitor_manager;
 
   settings->monitors_changed_id =
-    g_signal_connect (settings->monitor_manager, "monitors-changed",
-                      G_CALLBACK (monitors_changed_cb), settings);
+    g_signal_connect (settings->monitor_manager, "monitor-changes",
+                      G_CALLBACK (monitor_changes_cb), settings);
 
-  monitors_changed_cb (monitor_manager, settings);
+  update_mappable_devices (settings);
 }
@@ -62,3 +62,10 @@ gf_notifications_new (void)
 {
   return g_object_new (GF_TYPE_NOTIFICATIONS, NULL);
 }
+
+void
+gf_notifications_set_monitor_manager (GfNotifications  *notifications,
+                                      GfMonitorManager *monitor_manager)
+{
+  nd_daemon_set_monitor_manager (notifications->daemon, monitor_manager);
+}
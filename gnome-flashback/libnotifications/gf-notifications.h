@@ -18,7 +18,7 @@
 #ifndef GF_NOTIFICATIONS_H
 #define GF_NOTIFICATIONS_H
 
-#include <glib-object.h>
+#include "backends/gf-monitor-manager.h"
 
 G_BEGIN_DECLS
 
@@ -26,7 +26,10 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GfNotifications, gf_notifications,
                       GF, NOTIFICATIONS, GObject)
 
-GfNotifications *gf_notifications_new (void);
+GfNotifications *gf_notifications_new                 (void);
+
+void             gf_notifications_set_monitor_manager (GfNotifications  *notifications,
+                                                       GfMonitorManager *monitor_manager);
 
 G_END_DECLS
 
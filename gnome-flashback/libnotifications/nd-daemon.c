@@ -347,3 +347,10 @@ nd_daemon_new (void)
 {
   return g_object_new (ND_TYPE_DAEMON, NULL);
 }
+
+void
+nd_daemon_set_monitor_manager (NdDaemon         *daemon,
+                               GfMonitorManager *monitor_manager)
+{
+  nd_queue_set_monitor_manager (daemon->queue, monitor_manager);
+}
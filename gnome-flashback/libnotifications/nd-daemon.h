@@ -18,14 +18,17 @@
 #ifndef ND_DAEMON_H
 #define ND_DAEMON_H
 
-#include <glib-object.h>
+#include "backends/gf-monitor-manager.h"
 
 G_BEGIN_DECLS
 
 #define ND_TYPE_DAEMON nd_daemon_get_type ()
 G_DECLARE_FINAL_TYPE (NdDaemon, nd_daemon, ND, DAEMON, GObject)
 
-NdDaemon *nd_daemon_new (void);
+NdDaemon *nd_daemon_new                 (void);
+
+void      nd_daemon_set_monitor_manager (NdDaemon         *daemon,
+                                         GfMonitorManager *monitor_manager);
 
 G_END_DECLS
 
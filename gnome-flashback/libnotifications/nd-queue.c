@@ -52,6 +52,8 @@ struct NdQueuePrivate
 
         NotifyScreen  *screen;
 
+        GfMonitorManager *monitor_manager;
+
         guint          update_id;
 };
 
@@ -165,6 +167,18 @@ queue_update_position (gpointer key,
         nd_stack_queue_update_position ((NdStack *) value);
 }
 
+static void
+monitor_changes_cb (GfMonitorManager        *monitor_manager,
+                    const GfMonitorsChanges *changes,
+                    NdQueue                 *queue)
+{
+        if (gf_monitors_changes_is_empty (changes))
+                return;
+
+        /* stacks themselves come and go with GdkMonitor objects */
+        g_hash_table_foreach (queue->priv->screen->stacks, queue_update_position, NULL);
+}
+
 static GdkFilterReturn
 screen_xevent_filter (GdkXEvent    *xevent,
                       GdkEvent     *event,
@@ -972,3 +986,18 @@ nd_queue_new (void)
 {
         return g_object_new (ND_TYPE_QUEUE, NULL);
 }
+
+void
+nd_queue_set_monitor_manager (NdQueue          *queue,
+                              GfMonitorManager *monitor_manager)
+{
+        if (queue->priv->monitor_manager == monitor_manager)
+                return;
+
+        g_assert (queue->priv->monitor_manager == NULL);
+        queue->priv->monitor_manager = monitor_manager;
+
+        g_signal_connect_object (monitor_manager, "monitor-changes",
+                                 G_CALLBACK (monitor_changes_cb),
+                                 queue, 0);
+}
@@ -20,6 +20,7 @@
 
 #include <glib-object.h>
 
+#include "backends/gf-monitor-manager.h"
 #include "nd-notification.h"
 
 G_BEGIN_DECLS
@@ -58,6 +59,9 @@ void                nd_queue_add                            (NdQueue        *que
 void                nd_queue_remove_for_id                  (NdQueue        *queue,
                                                              guint           id);
 
+void                nd_queue_set_monitor_manager            (NdQueue          *queue,
+                                                             GfMonitorManager *monitor_manager);
+
 G_END_DECLS
 
 #endif /* __ND_QUEUE_H */
@@ -30,6 +30,11 @@
 
 #define XF86_MIN_GAMMA 0.1f
 
+/* Gamma changes are not tied to any window, so there is no frame clock
+ * to follow; step at the usual 60 Hz and derive alpha from the time.
+ */
+#define FADE_STEP_INTERVAL (G_USEC_PER_SEC / 60)
+
 /* VidModeExtension version 2.0 or better is needed to do gamma.
  * 2.0 added gamma values; 2.1 added gamma ramps.
  */
@@ -74,9 +79,15 @@ struct _GfFade
 
   GList            *tasks;
 
-  double            alpha_per_iter;
+  /* Monotonic times in microseconds */
+  gint64            start_time;
+  gint64            last_step_time;
+  gint64            duration;
   double            current_alpha;
 
+  guint             n_steps;
+  guint             n_dropped;
+
   guint             timeout_id;
 };
 
@@ -352,10 +363,27 @@ fade_stop (GfFade *self)
 static gboolean
 fade_out_iter (GfFade *self)
 {
+  gint64 now;
+
   if (self->current_alpha < 0.01)
     return FALSE;
 
-  self->current_alpha -= self->alpha_per_iter;
+  now = g_get_monotonic_time ();
+
+  /* Late steps are skipped, alpha follows the elapsed time instead */
+  if (self->n_steps > 0 &&
+      now - self->last_step_time > FADE_STEP_INTERVAL * 3 / 2)
+    self->n_dropped += (now - self->last_step_time) / FADE_STEP_INTERVAL - 1;
+
+  self->last_step_time = now;
+  self->n_steps++;
+
+  if (self->duration > 0)
+    self->current_alpha = 1.0 - (now - self->start_time) / (double) self->duration;
+  else
+    self->current_alpha = 0.0;
+
+  self->current_alpha = CLAMP (self->current_alpha, 0.0, 1.0);
 
   return set_alpha (self, self->current_alpha);
 }
@@ -386,6 +414,9 @@ fade_out_cb (gpointer user_data)
 
   if (!fade_out_iter (self))
     {
+      g_debug ("Screensaver fade finished: %u steps, %u dropped",
+               self->n_steps, self->n_dropped);
+
       gf_fade_complete (self);
       self->timeout_id = 0;
 
@@ -403,21 +434,21 @@ fade_start (GfFade *self,
 
   if (self->fade_type != GF_FADE_TYPE_NONE)
     {
-      guint steps_per_sec;
-      guint num_steps;
-
       if (!self->fade_setup (self))
         {
           gf_fade_complete (self);
           return;
         }
 
-      steps_per_sec = 60;
-      num_steps = (timeout / 1000.0) * steps_per_sec;
-
-      self->alpha_per_iter = 1.0 / (double) num_steps;
+      self->start_time = g_get_monotonic_time ();
+      self->last_step_time = self->start_time;
+      self->duration = timeout * (gint64) 1000;
+      self->n_steps = 0;
+      self->n_dropped = 0;
 
-      self->timeout_id = g_timeout_add (1000 / steps_per_sec, fade_out_cb, self);
+      self->timeout_id = g_timeout_add (FADE_STEP_INTERVAL / 1000,
+                                        fade_out_cb,
+                                        self);
       g_source_set_name_by_id (self->timeout_id, "[gnome-flashback] fade_out_cb");
     }
   else
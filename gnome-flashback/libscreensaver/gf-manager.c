@@ -60,6 +60,9 @@ struct _GfManager
 
   gulong            monitor_added_id;
   gulong            monitor_removed_id;
+
+  guint             sync_windows_id;
+  gboolean          windows_changed;
 };
 
 enum
@@ -440,32 +443,108 @@ create_window_for_monitor (GfManager  *self,
 }
 
 static void
-monitor_added_cb (GdkDisplay *display,
-                  GdkMonitor *monitor,
-                  GfManager  *self)
+cancel_unlock_func (gpointer data,
+                    gpointer user_data)
 {
-  GSList *l;
-  GfWindow *window;
+  gf_window_cancel_unlock_request (GF_WINDOW (data));
+}
 
-  g_debug ("Monitor added");
+static gboolean
+has_window_for_monitor (GfManager  *self,
+                        GdkMonitor *monitor)
+{
+  GSList *l;
 
-  /* tear down unlock dialog in case we want to move it to a new monitor */
   for (l = self->windows; l != NULL; l = l->next)
-    gf_window_cancel_unlock_request (GF_WINDOW (l->data));
+    {
+      if (gf_window_get_monitor (GF_WINDOW (l->data)) == monitor)
+        return TRUE;
+    }
 
-  /* add new window */
-  window = create_window_for_monitor (self, monitor);
-  self->windows = g_slist_prepend (self->windows, window);
+  return FALSE;
+}
+
+static gboolean
+sync_windows_cb (gpointer user_data)
+{
+  GfManager *self;
+  GdkDisplay *display;
+  int n_monitors;
+  int i;
+
+  self = GF_MANAGER (user_data);
+  self->sync_windows_id = 0;
+
+  display = gdk_display_get_default ();
+  n_monitors = gdk_display_get_n_monitors (display);
+
+  /* windows of monitors that are still there are kept as they are */
+  for (i = 0; i < n_monitors; i++)
+    {
+      GdkMonitor *monitor;
+      GfWindow *window;
+
+      monitor = gdk_display_get_monitor (display, i);
+
+      if (has_window_for_monitor (self, monitor))
+        continue;
+
+      window = create_window_for_monitor (self, monitor);
+      self->windows = g_slist_prepend (self->windows, window);
+      self->windows_changed = TRUE;
+    }
 
-  /* put unlock dialog up where ever it's supposed to be */
+  if (!self->windows_changed)
+    return G_SOURCE_REMOVE;
+
+  self->windows_changed = FALSE;
+
+  /* move unlock dialog to where ever it's supposed to be now */
+  g_slist_foreach (self->windows, cancel_unlock_func, NULL);
   gf_manager_request_unlock (self);
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
-cancel_unlock_func (gpointer data,
-                    gpointer user_data)
+queue_sync_windows (GfManager *self)
 {
-  gf_window_cancel_unlock_request (GF_WINDOW (data));
+  if (self->sync_windows_id != 0)
+    return;
+
+  self->sync_windows_id = g_idle_add (sync_windows_cb, self);
+  g_source_set_name_by_id (self->sync_windows_id,
+                           "[gnome-flashback] sync_windows_cb");
+}
+
+static void
+monitor_changes_cb (GfMonitorManager        *monitor_manager,
+                    const GfMonitorsChanges *changes,
+                    GfManager               *self)
+{
+  if (!self->active)
+    return;
+
+  /* windows follow their monitor geometry themselves */
+  if (gf_monitors_changes_get_n_added (changes) == 0 &&
+      gf_monitors_changes_get_n_removed (changes) == 0)
+    return;
+
+  queue_sync_windows (self);
+}
+
+/* GDK reads monitors on its own X connection, so its GdkMonitor objects
+ * can appear after "monitor-changes" was emitted. Both end up in the
+ * same idle sync.
+ */
+static void
+monitor_added_cb (GdkDisplay *display,
+                  GdkMonitor *monitor,
+                  GfManager  *self)
+{
+  g_debug ("Monitor added");
+
+  queue_sync_windows (self);
 }
 
 static void
@@ -477,23 +556,24 @@ monitor_removed_cb (GdkDisplay *display,
 
   g_debug ("Monitor removed");
 
-  /* tear down unlock dialog in case we want to move it to a new monitor */
-  g_slist_foreach (self->windows, cancel_unlock_func, NULL);
-
   /* destroy removed monitor window */
   for (l = self->windows; l != NULL; l = l->next)
     {
       if (gf_window_get_monitor (GF_WINDOW (l->data)) != monitor)
         continue;
 
+      /* tear down unlock dialog in case it is on the removed monitor */
+      g_slist_foreach (self->windows, cancel_unlock_func, NULL);
+
       self->windows = g_slist_remove_link (self->windows, l);
       gtk_widget_destroy (GTK_WIDGET (l->data));
       g_slist_free (l);
+
+      self->windows_changed = TRUE;
       break;
     }
 
-  /* put unlock dialog up where ever it's supposed to be */
-  gf_manager_request_unlock (self);
+  queue_sync_windows (self);
 }
 
 static void
@@ -543,8 +623,13 @@ destroy_windows (GfManager *self)
 {
   GdkDisplay *display;
 
-  if (self->windows == NULL)
-    return;
+  if (self->sync_windows_id != 0)
+    {
+      g_source_remove (self->sync_windows_id);
+      self->sync_windows_id = 0;
+    }
+
+  self->windows_changed = FALSE;
 
   display = gdk_display_get_default ();
 
@@ -689,7 +774,15 @@ void
 gf_manager_set_monitor_manager (GfManager        *self,
                                 GfMonitorManager *monitor_manager)
 {
+  if (self->monitor_manager == monitor_manager)
+    return;
+
+  g_assert (self->monitor_manager == NULL);
   self->monitor_manager = monitor_manager;
+
+  g_signal_connect_object (monitor_manager, "monitor-changes",
+                           G_CALLBACK (monitor_changes_cb),
+                           self, 0);
 }
 
 void
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Times the background pixel loops on 4K and 8K buffers and prints one
+ * JSON object per kernel and size on stdout. The transition blend is
+ * also timed with gdk_pixbuf_composite(), the call it replaced. The
+ * number of iterations can be given as the only argument.
+ */
+
+#include "config.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <stdlib.h>
+
+#include "gf-bg-kernels-private.h"
+
+#define DEFAULT_ITERATIONS 10
+
+/* Tile width of a wallpaper, as repeated by surface_tile() */
+#define TILE_WIDTH 256
+
+typedef struct
+{
+  int width;
+  int height;
+} BenchSize;
+
+static const BenchSize sizes[] =
+  {
+    { 3840, 2160 },
+    { 7680, 4320 }
+  };
+
+typedef void (* BenchFunc) (gpointer user_data);
+
+typedef struct
+{
+  int        width;
+  int        height;
+
+  guint32   *xrgb;
+  guint64    totals[3];
+
+  GdkPixbuf *from;
+  GdkPixbuf *to;
+  GdkPixbuf *dest;
+} BenchData;
+
+static void
+fill_pattern (guchar *data,
+              gsize   n_bytes)
+{
+  guint32 state;
+  gsize i;
+
+  /* Not constant, so that no loop gets to skip work */
+  state = 0x9e3779b9;
+
+  for (i = 0; i < n_bytes; i++)
+    {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+
+      data[i] = state & 0xFF;
+    }
+}
+
+static GdkPixbuf *
+create_pixbuf (int width,
+               int height)
+{
+  GdkPixbuf *pixbuf;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+
+  if (pixbuf == NULL)
+    g_error ("Failed to allocate a %dx%d pixbuf", width, height);
+
+  fill_pattern (gdk_pixbuf_get_pixels (pixbuf),
+                gdk_pixbuf_get_byte_length (pixbuf));
+
+  return pixbuf;
+}
+
+static void
+bench_average (gpointer user_data)
+{
+  BenchData *data;
+  int y;
+
+  data = user_data;
+
+  for (y = 0; y < data->height; y++)
+    {
+      gf_bg_sum_row_xrgb (data->xrgb + (gsize) y * data->width,
+                          data->width,
+                          &data->totals[0],
+                          &data->totals[1],
+                          &data->totals[2]);
+    }
+}
+
+static void
+bench_blend (gpointer user_data)
+{
+  BenchData *data;
+  const guchar *from;
+  const guchar *to;
+  guchar *dest;
+  int stride;
+  int y;
+
+  data = user_data;
+
+  from = gdk_pixbuf_read_pixels (data->from);
+  to = gdk_pixbuf_read_pixels (data->to);
+  dest = gdk_pixbuf_get_pixels (data->dest);
+  stride = gdk_pixbuf_get_rowstride (data->dest);
+
+  for (y = 0; y < data->height; y++)
+    {
+      gsize offset;
+
+      offset = (gsize) y * stride;
+
+      gf_bg_blend_row (to + offset,
+                       from + offset,
+                       dest + offset,
+                       data->width * 3,
+                       128);
+    }
+}
+
+static void
+bench_composite (gpointer user_data)
+{
+  BenchData *data;
+
+  data = user_data;
+
+  /* The blend as done before the kernel, a copy of the first slide
+   * with the second one composited on top */
+  gdk_pixbuf_copy_area (data->from,
+                        0, 0,
+                        data->width, data->height,
+                        data->dest,
+                        0, 0);
+
+  gdk_pixbuf_composite (data->to,
+                        data->dest,
+                        0, 0,
+                        data->width, data->height,
+                        0, 0,
+                        1, 1,
+                        GDK_INTERP_NEAREST,
+                        128);
+}
+
+static void
+bench_fill (gpointer user_data)
+{
+  BenchData *data;
+  int y;
+
+  data = user_data;
+
+  for (y = 0; y < data->height; y++)
+    {
+      guchar *row;
+
+      row = (guchar *) (data->xrgb + (gsize) y * data->width);
+
+      gf_bg_fill_row (row, row, TILE_WIDTH * 4, data->width * 4);
+    }
+}
+
+static void
+run_bench (const char *kernel,
+           BenchFunc   func,
+           BenchData  *data,
+           guint       iterations)
+{
+  gint64 total;
+  gint64 best;
+  guint i;
+
+  /* Faults the buffers in */
+  func (data);
+
+  total = 0;
+  best = G_MAXINT64;
+
+  for (i = 0; i < iterations; i++)
+    {
+      gint64 start;
+      gint64 elapsed;
+
+      start = g_get_monotonic_time ();
+      func (data);
+      elapsed = g_get_monotonic_time () - start;
+
+      total += elapsed;
+      best = MIN (best, elapsed);
+    }
+
+  g_print ("{\"kernel\": \"%s\", \"width\": %d, \"height\": %d, "
+           "\"iterations\": %u, "
+           "\"mean_usec\": %" G_GINT64_FORMAT ", "
+           "\"best_usec\": %" G_GINT64_FORMAT ", "
+           "\"mpixels_per_sec\": %.1f}\n",
+           kernel,
+           data->width,
+           data->height,
+           iterations,
+           total / iterations,
+           best,
+           (double) data->width * data->height * iterations / MAX (total, 1));
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint iterations;
+  guint i;
+
+  iterations = DEFAULT_ITERATIONS;
+
+  if (argc > 1)
+    iterations = g_ascii_strtoull (argv[1], NULL, 10);
+
+  if (iterations == 0)
+    {
+      g_printerr ("Usage: %s [ITERATIONS]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      BenchData data;
+      gsize n_bytes;
+
+      data = (BenchData) { 0 };
+      data.width = sizes[i].width;
+      data.height = sizes[i].height;
+
+      n_bytes = (gsize) data.width * data.height * 4;
+      data.xrgb = g_malloc (n_bytes);
+      fill_pattern ((guchar *) data.xrgb, n_bytes);
+
+      run_bench ("average", bench_average, &data, iterations);
+      run_bench ("fill", bench_fill, &data, iterations);
+
+      g_free (data.xrgb);
+
+      data.from = create_pixbuf (data.width, data.height);
+      data.to = create_pixbuf (data.width, data.height);
+      data.dest = create_pixbuf (data.width, data.height);
+
+      run_bench ("blend", bench_blend, &data, iterations);
+      run_bench ("gdk_pixbuf_composite", bench_composite, &data, iterations);
+
+      g_object_unref (data.from);
+      g_object_unref (data.to);
+      g_object_unref (data.dest);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,638 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Populates GfIconView from synthetic desktop directories and prints
+ * one JSON object per desktop size and cache state on stdout. It needs
+ * an X server and a session bus, see the "benchmark" target in
+ * Makefile.am.
+ */
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#include "gf-desktop-enums.h"
+#include "gf-icon-view.h"
+
+#define TIMEOUT_USEC (120 * G_USEC_PER_SEC)
+#define N_RUBBERBAND_STEPS 50
+
+static const guint default_sizes[] = { 100, 1000, 5000, 20000 };
+
+typedef struct
+{
+  gint64 first_paint;
+  gint64 populate;
+  gint64 resort;
+  gint64 rubberband;
+  guint  n_selected;
+  gint64 create;
+  gint64 delete;
+} BenchResult;
+
+typedef struct
+{
+  GtkWidget *window;
+  GtkWidget *icon_view;
+
+  gint64     start_time;
+  gint64     first_paint_time;
+  gint64     populated_time;
+
+  guint      n_icons;
+  char      *cache_file;
+} BenchView;
+
+typedef gboolean (* BenchCondition) (BenchView *view);
+
+static gboolean
+wakeup_cb (gpointer user_data)
+{
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+wait_for (BenchView      *view,
+          BenchCondition  condition)
+{
+  gint64 end_time;
+  guint wakeup_id;
+  gboolean ret;
+
+  end_time = g_get_monotonic_time () + TIMEOUT_USEC;
+  wakeup_id = g_timeout_add (100, wakeup_cb, NULL);
+  ret = TRUE;
+
+  while (!condition (view))
+    {
+      if (g_get_monotonic_time () > end_time)
+        {
+          ret = FALSE;
+          break;
+        }
+
+      g_main_context_iteration (NULL, TRUE);
+    }
+
+  g_source_remove (wakeup_id);
+
+  return ret;
+}
+
+static void
+drain (void)
+{
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+static gboolean
+has_placed_icon (GtkWidget *icon_view)
+{
+  GtkWidget *fixed;
+  GList *views;
+  GList *l;
+  gboolean placed;
+
+  fixed = gtk_bin_get_child (GTK_BIN (icon_view));
+  views = gtk_container_get_children (GTK_CONTAINER (fixed));
+  placed = FALSE;
+
+  for (l = views; l != NULL && !placed; l = l->next)
+    {
+      GList *icons;
+      GList *i;
+
+      icons = gtk_container_get_children (GTK_CONTAINER (l->data));
+
+      for (i = icons; i != NULL; i = i->next)
+        {
+          if (gtk_widget_get_mapped (i->data))
+            {
+              placed = TRUE;
+              break;
+            }
+        }
+
+      g_list_free (icons);
+    }
+
+  g_list_free (views);
+
+  return placed;
+}
+
+static void
+after_paint_cb (GdkFrameClock *frame_clock,
+                BenchView     *view)
+{
+  if (view->first_paint_time != 0 || view->icon_view == NULL)
+    return;
+
+  if (has_placed_icon (view->icon_view))
+    view->first_paint_time = g_get_monotonic_time ();
+}
+
+static gboolean
+is_ready (BenchView *view)
+{
+  if (view->populated_time == 0 &&
+      gf_icon_view_is_populated (GF_ICON_VIEW (view->icon_view)))
+    view->populated_time = g_get_monotonic_time ();
+
+  return view->populated_time != 0 && view->first_paint_time != 0;
+}
+
+static gboolean
+has_n_icons (BenchView *view)
+{
+  return gf_icon_view_get_n_icons (GF_ICON_VIEW (view->icon_view)) == view->n_icons;
+}
+
+static gboolean
+has_cache_file (BenchView *view)
+{
+  return g_file_test (view->cache_file, G_FILE_TEST_EXISTS);
+}
+
+static char *
+get_cache_file (const char *desktop_dir)
+{
+  char *uri;
+  char *checksum;
+  char *basename;
+  char *filename;
+
+  /* Same as get_cache_filename() in gf-icon-cache.c */
+  uri = g_filename_to_uri (desktop_dir, NULL, NULL);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+  basename = g_strdup_printf ("%s.cache", checksum);
+
+  filename = g_build_filename (g_get_user_cache_dir (),
+                               "gnome-flashback",
+                               "desktop",
+                               basename,
+                               NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (uri);
+
+  return filename;
+}
+
+static void
+create_files (const char *desktop_dir,
+              const char *prefix,
+              guint       n_files)
+{
+  guint i;
+
+  for (i = 0; i < n_files; i++)
+    {
+      char *basename;
+      char *filename;
+      char *contents;
+      GError *error;
+
+      basename = g_strdup_printf ("%s-%05u.txt", prefix, i);
+      filename = g_build_filename (desktop_dir, basename, NULL);
+
+      /* Vary the size so that sorting by size changes the order */
+      contents = g_strnfill ((i * 7919) % 4096, 'x');
+
+      error = NULL;
+      if (!g_file_set_contents_full (filename, contents, -1,
+                                     G_FILE_SET_CONTENTS_NONE,
+                                     0644, &error))
+        g_error ("%s", error->message);
+
+      g_free (contents);
+      g_free (filename);
+      g_free (basename);
+    }
+}
+
+static void
+delete_files (const char *desktop_dir,
+              const char *prefix,
+              guint       n_files)
+{
+  guint i;
+
+  for (i = 0; i < n_files; i++)
+    {
+      char *basename;
+      char *filename;
+
+      basename = g_strdup_printf ("%s-%05u.txt", prefix, i);
+      filename = g_build_filename (desktop_dir, basename, NULL);
+
+      g_unlink (filename);
+
+      g_free (filename);
+      g_free (basename);
+    }
+}
+
+static void
+remove_tree (const char *path)
+{
+  GDir *dir;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          char *child;
+
+          child = g_build_filename (path, name, NULL);
+          remove_tree (child);
+          g_free (child);
+        }
+
+      g_dir_close (dir);
+    }
+
+  g_remove (path);
+}
+
+static void
+set_desktop_dir (const char *desktop_dir)
+{
+  char *dirs_file;
+  char *contents;
+  GError *error;
+
+  dirs_file = g_build_filename (g_get_user_config_dir (),
+                                "user-dirs.dirs",
+                                NULL);
+
+  contents = g_strdup_printf ("XDG_DESKTOP_DIR=\"%s\"\n", desktop_dir);
+
+  error = NULL;
+  if (!g_file_set_contents (dirs_file, contents, -1, &error))
+    g_error ("%s", error->message);
+
+  g_reload_user_special_dirs_cache ();
+
+  g_free (contents);
+  g_free (dirs_file);
+}
+
+static void
+send_button (GtkWidget    *widget,
+             GdkEventType  type,
+             double        x,
+             double        y,
+             guint32       time)
+{
+  GdkSeat *seat;
+  GdkEvent *event;
+
+  seat = gdk_display_get_default_seat (gtk_widget_get_display (widget));
+  event = gdk_event_new (type);
+
+  event->button.window = g_object_ref (gtk_widget_get_window (widget));
+  event->button.send_event = TRUE;
+  event->button.time = time;
+  event->button.x = x;
+  event->button.y = y;
+  event->button.x_root = x;
+  event->button.y_root = y;
+  event->button.button = GDK_BUTTON_PRIMARY;
+
+  if (type == GDK_BUTTON_RELEASE)
+    event->button.state = GDK_BUTTON1_MASK;
+
+  gdk_event_set_device (event, gdk_seat_get_pointer (seat));
+
+  gtk_main_do_event (event);
+  gdk_event_free (event);
+}
+
+static void
+send_motion (GtkWidget *widget,
+             double     x,
+             double     y,
+             guint32    time)
+{
+  GdkSeat *seat;
+  GdkEvent *event;
+
+  seat = gdk_display_get_default_seat (gtk_widget_get_display (widget));
+  event = gdk_event_new (GDK_MOTION_NOTIFY);
+
+  event->motion.window = g_object_ref (gtk_widget_get_window (widget));
+  event->motion.send_event = TRUE;
+  event->motion.time = time;
+  event->motion.x = x;
+  event->motion.y = y;
+  event->motion.x_root = x;
+  event->motion.y_root = y;
+  event->motion.state = GDK_BUTTON1_MASK;
+
+  gdk_event_set_device (event, gdk_seat_get_pointer (seat));
+
+  gtk_main_do_event (event);
+  gdk_event_free (event);
+}
+
+static gint64
+rubberband_select (BenchView *view,
+                   guint     *n_selected)
+{
+  GtkAllocation allocation;
+  gint64 start_time;
+  guint32 time;
+  int i;
+
+  gtk_widget_get_allocation (view->icon_view, &allocation);
+
+  start_time = g_get_monotonic_time ();
+  time = 1;
+
+  send_button (view->icon_view, GDK_BUTTON_PRESS, 1, 1, time++);
+
+  /* Drag across the whole view, painting after every step */
+  for (i = 1; i <= N_RUBBERBAND_STEPS; i++)
+    {
+      send_motion (view->icon_view,
+                   1 + (allocation.width - 2) * i / N_RUBBERBAND_STEPS,
+                   1 + (allocation.height - 2) * i / N_RUBBERBAND_STEPS,
+                   time++);
+
+      drain ();
+    }
+
+  send_button (view->icon_view, GDK_BUTTON_RELEASE,
+               allocation.width - 1, allocation.height - 1, time++);
+
+  drain ();
+
+  *n_selected = g_list_length (gf_icon_view_get_selected_icons (GF_ICON_VIEW (view->icon_view)));
+  gf_icon_view_clear_selection (GF_ICON_VIEW (view->icon_view));
+
+  return g_get_monotonic_time () - start_time;
+}
+
+static gboolean
+run_view (GSettings   *settings,
+          const char  *desktop_dir,
+          guint        n_files,
+          gboolean     save_cache,
+          BenchResult *result)
+{
+  GdkDisplay *display;
+  GdkMonitor *monitor;
+  GdkRectangle geometry;
+  BenchView view;
+  guint n_created;
+  gint64 start_time;
+  gboolean ret;
+
+  display = gdk_display_get_default ();
+  monitor = gdk_display_get_primary_monitor (display);
+
+  if (monitor == NULL)
+    monitor = gdk_display_get_monitor (display, 0);
+
+  gdk_monitor_get_geometry (monitor, &geometry);
+
+  view = (BenchView) { 0 };
+  view.cache_file = get_cache_file (desktop_dir);
+  ret = FALSE;
+
+  view.window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_decorated (GTK_WINDOW (view.window), FALSE);
+  gtk_window_move (GTK_WINDOW (view.window), geometry.x, geometry.y);
+  gtk_window_set_default_size (GTK_WINDOW (view.window),
+                               geometry.width,
+                               geometry.height);
+
+  gtk_widget_realize (view.window);
+
+  g_signal_connect (gtk_widget_get_frame_clock (view.window),
+                    "after-paint",
+                    G_CALLBACK (after_paint_cb),
+                    &view);
+
+  view.start_time = g_get_monotonic_time ();
+
+  view.icon_view = gf_icon_view_new ();
+  gtk_container_add (GTK_CONTAINER (view.window), view.icon_view);
+  gtk_widget_show_all (view.window);
+
+  if (!wait_for (&view, is_ready))
+    {
+      g_printerr ("Timed out populating %u icons\n", n_files);
+      goto out;
+    }
+
+  result->first_paint = view.first_paint_time - view.start_time;
+  result->populate = view.populated_time - view.start_time;
+
+  start_time = g_get_monotonic_time ();
+  g_settings_set_enum (settings, "sort-by", GF_SORT_BY_SIZE);
+  drain ();
+  result->resort = g_get_monotonic_time () - start_time;
+
+  g_settings_set_enum (settings, "sort-by", GF_SORT_BY_NAME);
+  drain ();
+
+  result->rubberband = rubberband_select (&view, &result->n_selected);
+
+  /* File monitor events are only read once the main loop runs again */
+  n_created = MAX (n_files / 10, 10);
+  create_files (desktop_dir, "new", n_created);
+
+  start_time = g_get_monotonic_time ();
+  view.n_icons = n_files + n_created;
+
+  if (!wait_for (&view, has_n_icons))
+    {
+      g_printerr ("Timed out creating %u icons\n", n_created);
+      goto out;
+    }
+
+  drain ();
+  result->create = g_get_monotonic_time () - start_time;
+
+  delete_files (desktop_dir, "new", n_created);
+
+  start_time = g_get_monotonic_time ();
+  view.n_icons = n_files;
+
+  if (!wait_for (&view, has_n_icons))
+    {
+      g_printerr ("Timed out deleting %u icons\n", n_created);
+      goto out;
+    }
+
+  drain ();
+  result->delete = g_get_monotonic_time () - start_time;
+
+  if (save_cache && !wait_for (&view, has_cache_file))
+    {
+      g_printerr ("Timed out saving the icon cache\n");
+      goto out;
+    }
+
+  ret = TRUE;
+
+out:
+  g_signal_handlers_disconnect_by_func (gtk_widget_get_frame_clock (view.window),
+                                        after_paint_cb,
+                                        &view);
+
+  gtk_widget_destroy (view.window);
+  drain ();
+
+  g_free (view.cache_file);
+
+  return ret;
+}
+
+static void
+print_result (guint              n_files,
+              const char        *cache,
+              const BenchResult *result)
+{
+  g_print ("{\"n_files\": %u, \"cache\": \"%s\", "
+           "\"first_paint_usec\": %" G_GINT64_FORMAT ", "
+           "\"populate_usec\": %" G_GINT64_FORMAT ", "
+           "\"resort_usec\": %" G_GINT64_FORMAT ", "
+           "\"rubberband_usec\": %" G_GINT64_FORMAT ", "
+           "\"rubberband_selected\": %u, "
+           "\"create_usec\": %" G_GINT64_FORMAT ", "
+           "\"delete_usec\": %" G_GINT64_FORMAT "}\n",
+           n_files,
+           cache,
+           result->first_paint,
+           result->populate,
+           result->resort,
+           result->rubberband,
+           result->n_selected,
+           result->create,
+           result->delete);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  GError *error;
+  char *root;
+  char *config_dir;
+  char *cache_dir;
+  GArray *sizes;
+  GSettings *settings;
+  int status;
+  guint i;
+
+  error = NULL;
+  root = g_dir_make_tmp ("gf-bench-icon-view-XXXXXX", &error);
+
+  if (root == NULL)
+    g_error ("%s", error->message);
+
+  config_dir = g_build_filename (root, "config", NULL);
+  cache_dir = g_build_filename (root, "cache", NULL);
+
+  g_mkdir_with_parents (config_dir, 0700);
+  g_mkdir_with_parents (cache_dir, 0700);
+
+  /* Keep the user's settings, desktop and icon cache out of the way */
+  g_setenv ("XDG_CONFIG_HOME", config_dir, TRUE);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+  g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+
+  gtk_init (&argc, &argv);
+
+  sizes = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 1; i < (guint) argc; i++)
+    {
+      guint n_files;
+
+      n_files = g_ascii_strtoull (argv[i], NULL, 10);
+
+      if (n_files > 0)
+        g_array_append_val (sizes, n_files);
+    }
+
+  if (sizes->len == 0)
+    g_array_append_vals (sizes, default_sizes, G_N_ELEMENTS (default_sizes));
+
+  settings = g_settings_new ("org.gnome.gnome-flashback.desktop.icons");
+
+  g_settings_set_boolean (settings, "show-home", FALSE);
+  g_settings_set_boolean (settings, "show-trash", FALSE);
+  g_settings_set_enum (settings, "placement", GF_PLACEMENT_AUTO_ARRANGE_ICONS);
+  g_settings_set_enum (settings, "sort-by", GF_SORT_BY_NAME);
+
+  status = EXIT_SUCCESS;
+
+  for (i = 0; i < sizes->len; i++)
+    {
+      guint n_files;
+      char *basename;
+      char *desktop_dir;
+      BenchResult result;
+
+      n_files = g_array_index (sizes, guint, i);
+
+      basename = g_strdup_printf ("desktop-%u", n_files);
+      desktop_dir = g_build_filename (root, basename, NULL);
+      g_free (basename);
+
+      g_mkdir_with_parents (desktop_dir, 0700);
+      create_files (desktop_dir, "file", n_files);
+      set_desktop_dir (desktop_dir);
+
+      /* The first run saves the icon cache that the second run loads */
+      result = (BenchResult) { 0 };
+      if (run_view (settings, desktop_dir, n_files, TRUE, &result))
+        print_result (n_files, "cold", &result);
+      else
+        status = EXIT_FAILURE;
+
+      result = (BenchResult) { 0 };
+      if (run_view (settings, desktop_dir, n_files, FALSE, &result))
+        print_result (n_files, "warm", &result);
+      else
+        status = EXIT_FAILURE;
+
+      g_free (desktop_dir);
+    }
+
+  g_object_unref (settings);
+  g_array_unref (sizes);
+
+  remove_tree (root);
+
+  g_free (cache_dir);
+  g_free (config_dir);
+  g_free (root);
+
+  return status;
+}
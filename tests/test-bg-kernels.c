@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the background pixel loops with plain scalar versions. The
+ * loops are built with target_clones, on a machine with AVX2 this
+ * checks the AVX2 clone, otherwise the default one. Widths cover every
+ * vector tail length and the values are random.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "gf-bg-kernels-private.h"
+
+#define MAX_WIDTH 300
+
+static guint
+div_255 (guint value)
+{
+  return (value + 127) / 255;
+}
+
+static void
+fill_random (guchar *data,
+             gsize   n_bytes)
+{
+  gsize i;
+
+  for (i = 0; i < n_bytes; i++)
+    data[i] = g_test_rand_int_range (0, 256);
+}
+
+static void
+test_sum_row_xrgb (void)
+{
+  guint32 row[MAX_WIDTH];
+  int width;
+
+  for (width = 0; width <= MAX_WIDTH; width++)
+    {
+      guint64 r;
+      guint64 g;
+      guint64 b;
+      guint64 expected_r;
+      guint64 expected_g;
+      guint64 expected_b;
+      int i;
+
+      fill_random ((guchar *) row, sizeof (row));
+
+      /* Totals are added to, not replaced */
+      r = expected_r = 1;
+      g = expected_g = 2;
+      b = expected_b = 3;
+
+      for (i = 0; i < width; i++)
+        {
+          expected_r += (row[i] >> 16) & 0xFF;
+          expected_g += (row[i] >> 8) & 0xFF;
+          expected_b += row[i] & 0xFF;
+        }
+
+      gf_bg_sum_row_xrgb (row, width, &r, &g, &b);
+
+      g_assert_cmpuint (r, ==, expected_r);
+      g_assert_cmpuint (g, ==, expected_g);
+      g_assert_cmpuint (b, ==, expected_b);
+    }
+}
+
+static void
+test_convert_row_rgb (void)
+{
+  guchar src[3 * MAX_WIDTH];
+  guint32 dest[MAX_WIDTH + 1];
+  int width;
+
+  for (width = 0; width <= MAX_WIDTH; width++)
+    {
+      int i;
+
+      fill_random (src, sizeof (src));
+      dest[width] = 0xDEADBEEF;
+
+      gf_bg_convert_row_rgb (src, dest, width);
+
+      for (i = 0; i < width; i++)
+        {
+          guint32 expected;
+
+          expected = 0xFF000000 |
+                     (guint32) src[3 * i] << 16 |
+                     (guint32) src[3 * i + 1] << 8 |
+                     (guint32) src[3 * i + 2];
+
+          g_assert_cmphex (dest[i], ==, expected);
+        }
+
+      g_assert_cmphex (dest[width], ==, 0xDEADBEEF);
+    }
+}
+
+static void
+test_composite_row_rgba (void)
+{
+  guchar src[4 * MAX_WIDTH];
+  guint32 dest[MAX_WIDTH + 1];
+  guint32 base[MAX_WIDTH];
+  int width;
+
+  for (width = 0; width <= MAX_WIDTH; width++)
+    {
+      int i;
+
+      fill_random (src, sizeof (src));
+      fill_random ((guchar *) base, sizeof (base));
+
+      /* Fully transparent and fully opaque pixels are the common case */
+      if (width > 1)
+        {
+          src[3] = 0x00;
+          src[7] = 0xFF;
+        }
+
+      memcpy (dest, base, sizeof (base));
+      dest[width] = 0xDEADBEEF;
+
+      gf_bg_composite_row_rgba (src, dest, width);
+
+      for (i = 0; i < width; i++)
+        {
+          guint alpha;
+          guint32 expected;
+          int shift;
+          int c;
+
+          alpha = src[4 * i + 3];
+          expected = 0xFF000000;
+
+          for (c = 0, shift = 16; c < 3; c++, shift -= 8)
+            {
+              guint value;
+
+              value = src[4 * i + c] * alpha +
+                      ((base[i] >> shift) & 0xFF) * (0xFF - alpha);
+
+              expected |= div_255 (value) << shift;
+            }
+
+          g_assert_cmphex (dest[i], ==, expected);
+        }
+
+      g_assert_cmphex (dest[width], ==, 0xDEADBEEF);
+    }
+}
+
+static void
+check_blend_row (gboolean in_place)
+{
+  static const guint alphas[] = { 0x00, 0x01, 0x7F, 0x80, 0xFE, 0xFF };
+  guchar src[3 * MAX_WIDTH];
+  guchar base[3 * MAX_WIDTH];
+  guchar dest[3 * MAX_WIDTH + 1];
+  int n_bytes;
+
+  for (n_bytes = 0; n_bytes <= 3 * MAX_WIDTH; n_bytes++)
+    {
+      guint alpha;
+      int i;
+
+      fill_random (src, sizeof (src));
+      fill_random (base, sizeof (base));
+
+      if (n_bytes < (int) G_N_ELEMENTS (alphas))
+        alpha = alphas[n_bytes];
+      else
+        alpha = g_test_rand_int_range (0, 256);
+
+      memcpy (dest, base, sizeof (base));
+      dest[n_bytes] = 0xA5;
+
+      gf_bg_blend_row (src, in_place ? dest : base, dest, n_bytes, alpha);
+
+      for (i = 0; i < n_bytes; i++)
+        {
+          guint expected;
+
+          expected = div_255 (src[i] * alpha + base[i] * (0xFF - alpha));
+
+          g_assert_cmpuint (dest[i], ==, expected);
+        }
+
+      g_assert_cmpuint (dest[n_bytes], ==, 0xA5);
+    }
+}
+
+static void
+test_blend_row (void)
+{
+  check_blend_row (FALSE);
+}
+
+static void
+test_blend_row_in_place (void)
+{
+  check_blend_row (TRUE);
+}
+
+static void
+test_fill_row (void)
+{
+  guchar pattern[64];
+  guchar dest[4 * MAX_WIDTH + 1];
+  int pattern_bytes;
+
+  fill_random (pattern, sizeof (pattern));
+
+  for (pattern_bytes = 1; pattern_bytes <= (int) sizeof (pattern); pattern_bytes++)
+    {
+      int n_bytes;
+
+      for (n_bytes = 0; n_bytes <= 4 * MAX_WIDTH; n_bytes += 7)
+        {
+          int i;
+
+          /* The tiling code fills a row from its own beginning */
+          memcpy (dest, pattern, pattern_bytes);
+          dest[n_bytes] = 0xA5;
+
+          gf_bg_fill_row (dest, dest, pattern_bytes, n_bytes);
+
+          for (i = 0; i < n_bytes; i++)
+            g_assert_cmpuint (dest[i], ==, pattern[i % pattern_bytes]);
+
+          if (n_bytes >= pattern_bytes)
+            g_assert_cmpuint (dest[n_bytes], ==, 0xA5);
+
+          memset (dest, 0, sizeof (dest));
+          dest[n_bytes] = 0xA5;
+
+          gf_bg_fill_row (dest, pattern, pattern_bytes, n_bytes);
+
+          for (i = 0; i < n_bytes; i++)
+            g_assert_cmpuint (dest[i], ==, pattern[i % pattern_bytes]);
+
+          g_assert_cmpuint (dest[n_bytes], ==, 0xA5);
+        }
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/bg-kernels/sum-row-xrgb", test_sum_row_xrgb);
+  g_test_add_func ("/bg-kernels/convert-row-rgb", test_convert_row_rgb);
+  g_test_add_func ("/bg-kernels/composite-row-rgba", test_composite_row_rgba);
+  g_test_add_func ("/bg-kernels/blend-row", test_blend_row);
+  g_test_add_func ("/bg-kernels/blend-row-in-place", test_blend_row_in_place);
+  g_test_add_func ("/bg-kernels/fill-row", test_fill_row);
+
+  return g_test_run ();
+}
@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Builds CRTC assignments against a fake GPU state and checks the XRandR
+ * requests planned for them. Nothing talks to an X server.
+ */
+
+#include "config.h"
+
+#include "gf-crtc-mode-info-private.h"
+#include "gf-output-private.h"
+#include "gf-xrandr-plan-private.h"
+
+#define TEST_TYPE_CRTC (test_crtc_get_type ())
+G_DECLARE_FINAL_TYPE (TestCrtc, test_crtc, TEST, CRTC, GfCrtc)
+
+struct _TestCrtc
+{
+  GfCrtc parent;
+};
+
+G_DEFINE_TYPE (TestCrtc, test_crtc, GF_TYPE_CRTC)
+
+static void
+test_crtc_class_init (TestCrtcClass *self_class)
+{
+}
+
+static void
+test_crtc_init (TestCrtc *self)
+{
+}
+
+#define TEST_TYPE_OUTPUT (test_output_get_type ())
+G_DECLARE_FINAL_TYPE (TestOutput, test_output, TEST, OUTPUT, GfOutput)
+
+struct _TestOutput
+{
+  GfOutput parent;
+};
+
+G_DEFINE_TYPE (TestOutput, test_output, GF_TYPE_OUTPUT)
+
+static void
+test_output_class_init (TestOutputClass *self_class)
+{
+}
+
+static void
+test_output_init (TestOutput *self)
+{
+}
+
+typedef struct
+{
+  GfGpu      *gpu;
+
+  GfCrtcMode *mode_1080p;
+  GfCrtcMode *mode_720p;
+
+  GfCrtc     *crtc_a;
+  GfCrtc     *crtc_b;
+
+  GfOutput   *output_a;
+  GfOutput   *output_b;
+
+  /* Size of the X screen for the current state */
+  int         screen_width;
+  int         screen_height;
+} Fixture;
+
+static GfCrtcMode *
+mode_new (uint64_t id,
+          int      width,
+          int      height)
+{
+  GfCrtcModeInfo *info;
+  GfCrtcMode *mode;
+
+  info = gf_crtc_mode_info_new ();
+  info->width = width;
+  info->height = height;
+  info->refresh_rate = 60.0;
+
+  mode = g_object_new (GF_TYPE_CRTC_MODE,
+                       "id", id,
+                       "info", info,
+                       NULL);
+
+  gf_crtc_mode_info_unref (info);
+
+  return mode;
+}
+
+static void
+fixture_set_up (Fixture       *fixture,
+                gconstpointer  user_data)
+{
+  fixture->gpu = g_object_new (GF_TYPE_GPU, NULL);
+
+  fixture->mode_1080p = mode_new (1, 1920, 1080);
+  fixture->mode_720p = mode_new (2, 1280, 720);
+
+  fixture->crtc_a = g_object_new (TEST_TYPE_CRTC,
+                                  "id", (uint64_t) 10,
+                                  "gpu", fixture->gpu,
+                                  NULL);
+
+  fixture->crtc_b = g_object_new (TEST_TYPE_CRTC,
+                                  "id", (uint64_t) 11,
+                                  "gpu", fixture->gpu,
+                                  NULL);
+
+  fixture->output_a = g_object_new (TEST_TYPE_OUTPUT,
+                                    "id", (uint64_t) 20,
+                                    "gpu", fixture->gpu,
+                                    NULL);
+
+  fixture->output_b = g_object_new (TEST_TYPE_OUTPUT,
+                                    "id", (uint64_t) 21,
+                                    "gpu", fixture->gpu,
+                                    NULL);
+
+  gf_gpu_take_modes (fixture->gpu,
+                     g_list_append (g_list_append (NULL, fixture->mode_1080p),
+                                    fixture->mode_720p));
+
+  gf_gpu_take_crtcs (fixture->gpu,
+                     g_list_append (g_list_append (NULL, fixture->crtc_a),
+                                    fixture->crtc_b));
+
+  gf_gpu_take_outputs (fixture->gpu,
+                       g_list_append (g_list_append (NULL, fixture->output_a),
+                                      fixture->output_b));
+}
+
+static void
+fixture_tear_down (Fixture       *fixture,
+                   gconstpointer  user_data)
+{
+  g_object_unref (fixture->gpu);
+}
+
+/* Puts @crtc into the current state, as if read back from the server */
+static void
+set_current (GfCrtc     *crtc,
+             GfCrtcMode *mode,
+             int         x,
+             int         y,
+             GfOutput   *output,
+             ...)
+{
+  const GfCrtcModeInfo *info;
+  GfRectangle layout;
+  va_list args;
+
+  info = gf_crtc_mode_get_info (mode);
+  layout = (GfRectangle) { x, y, info->width, info->height };
+
+  gf_crtc_set_config (crtc, &layout, mode, GF_MONITOR_TRANSFORM_NORMAL);
+
+  va_start (args, output);
+
+  while (output != NULL)
+    {
+      GfOutputAssignment output_assignment = { 0 };
+
+      output_assignment.output = output;
+      gf_output_assign_crtc (output, crtc, &output_assignment);
+
+      output = va_arg (args, GfOutput *);
+    }
+
+  va_end (args);
+}
+
+static GfCrtcAssignment *
+assignment_new (GfCrtc     *crtc,
+                GfCrtcMode *mode,
+                int         x,
+                int         y,
+                GfOutput   *output,
+                ...)
+{
+  const GfCrtcModeInfo *info;
+  GfCrtcAssignment *crtc_assignment;
+  va_list args;
+
+  info = gf_crtc_mode_get_info (mode);
+
+  crtc_assignment = g_new0 (GfCrtcAssignment, 1);
+  crtc_assignment->crtc = crtc;
+  crtc_assignment->mode = mode;
+  crtc_assignment->layout = (GfRectangle) { x, y, info->width, info->height };
+  crtc_assignment->transform = GF_MONITOR_TRANSFORM_NORMAL;
+  crtc_assignment->outputs = g_ptr_array_new ();
+
+  va_start (args, output);
+
+  while (output != NULL)
+    {
+      g_ptr_array_add (crtc_assignment->outputs, output);
+      output = va_arg (args, GfOutput *);
+    }
+
+  va_end (args);
+
+  return crtc_assignment;
+}
+
+static void
+assignment_free (GfCrtcAssignment *crtc_assignment)
+{
+  g_ptr_array_unref (crtc_assignment->outputs);
+  g_free (crtc_assignment);
+}
+
+static GArray *
+plan (Fixture           *fixture,
+      GfCrtcAssignment **crtcs,
+      guint              n_crtcs)
+{
+  return gf_xrandr_plan_crtc_assignments (fixture->gpu,
+                                          fixture->screen_width,
+                                          fixture->screen_height,
+                                          crtcs,
+                                          n_crtcs);
+}
+
+static GfXrandrOp *
+get_op (GArray *ops,
+        guint   index)
+{
+  return &g_array_index (ops, GfXrandrOp, index);
+}
+
+/* Scale and primary only live in the logical monitor and output
+ * assignments, so the CRTC assignments are exactly the current state */
+static void
+test_unchanged (Fixture       *fixture,
+                gconstpointer  user_data)
+{
+  GfCrtcAssignment *crtcs[2];
+  GArray *ops;
+
+  set_current (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+               fixture->output_a, NULL);
+  set_current (fixture->crtc_b, fixture->mode_1080p, 1920, 0,
+               fixture->output_b, NULL);
+
+  fixture->screen_width = 3840;
+  fixture->screen_height = 1080;
+
+  crtcs[0] = assignment_new (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+                             fixture->output_a, NULL);
+  crtcs[1] = assignment_new (fixture->crtc_b, fixture->mode_1080p, 1920, 0,
+                             fixture->output_b, NULL);
+
+  ops = plan (fixture, crtcs, G_N_ELEMENTS (crtcs));
+  g_assert_cmpuint (ops->len, ==, 0);
+  g_array_unref (ops);
+
+  assignment_free (crtcs[0]);
+  assignment_free (crtcs[1]);
+}
+
+static void
+test_shrink (Fixture       *fixture,
+             gconstpointer  user_data)
+{
+  GfCrtcAssignment *crtcs[2];
+  GArray *ops;
+  guint i;
+
+  set_current (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+               fixture->output_a, NULL);
+  set_current (fixture->crtc_b, fixture->mode_1080p, 1920, 0,
+               fixture->output_b, NULL);
+
+  fixture->screen_width = 3840;
+  fixture->screen_height = 1080;
+
+  /* The right monitor switches to a smaller mode */
+  crtcs[0] = assignment_new (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+                             fixture->output_a, NULL);
+  crtcs[1] = assignment_new (fixture->crtc_b, fixture->mode_720p, 1920, 0,
+                             fixture->output_b, NULL);
+
+  ops = plan (fixture, crtcs, G_N_ELEMENTS (crtcs));
+  g_assert_cmpuint (ops->len, ==, 3);
+
+  g_assert_cmpint (get_op (ops, 0)->type, ==, GF_XRANDR_OP_DISABLE_CRTC);
+  g_assert_true (get_op (ops, 0)->crtc == fixture->crtc_b);
+
+  g_assert_cmpint (get_op (ops, 1)->type, ==, GF_XRANDR_OP_SET_SCREEN_SIZE);
+  g_assert_cmpint (get_op (ops, 1)->width, ==, 3200);
+  g_assert_cmpint (get_op (ops, 1)->height, ==, 1080);
+
+  g_assert_cmpint (get_op (ops, 2)->type, ==, GF_XRANDR_OP_SET_CRTC_CONFIG);
+  g_assert_true (get_op (ops, 2)->crtc_assignment == crtcs[1]);
+
+  /* The left monitor fits into the new screen and does not change */
+  for (i = 0; i < ops->len; i++)
+    g_assert_true (get_op (ops, i)->crtc != fixture->crtc_a);
+
+  g_array_unref (ops);
+
+  assignment_free (crtcs[0]);
+  assignment_free (crtcs[1]);
+}
+
+static void
+test_shrink_disable (Fixture       *fixture,
+                     gconstpointer  user_data)
+{
+  GfCrtcAssignment *crtcs[1];
+  GArray *ops;
+
+  set_current (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+               fixture->output_a, NULL);
+  set_current (fixture->crtc_b, fixture->mode_1080p, 1920, 0,
+               fixture->output_b, NULL);
+
+  fixture->screen_width = 3840;
+  fixture->screen_height = 1080;
+
+  /* The right monitor is turned off */
+  crtcs[0] = assignment_new (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+                             fixture->output_a, NULL);
+
+  ops = plan (fixture, crtcs, G_N_ELEMENTS (crtcs));
+  g_assert_cmpuint (ops->len, ==, 2);
+
+  g_assert_cmpint (get_op (ops, 0)->type, ==, GF_XRANDR_OP_DISABLE_CRTC);
+  g_assert_true (get_op (ops, 0)->crtc == fixture->crtc_b);
+
+  g_assert_cmpint (get_op (ops, 1)->type, ==, GF_XRANDR_OP_SET_SCREEN_SIZE);
+  g_assert_cmpint (get_op (ops, 1)->width, ==, 1920);
+  g_assert_cmpint (get_op (ops, 1)->height, ==, 1080);
+
+  g_array_unref (ops);
+
+  assignment_free (crtcs[0]);
+}
+
+static void
+test_unclone (Fixture       *fixture,
+              gconstpointer  user_data)
+{
+  GfCrtcAssignment *crtcs[1];
+  GArray *ops;
+
+  set_current (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+               fixture->output_a, fixture->output_b, NULL);
+
+  fixture->screen_width = 1920;
+  fixture->screen_height = 1080;
+
+  /* Same mode and position, one of the clones is dropped */
+  crtcs[0] = assignment_new (fixture->crtc_a, fixture->mode_1080p, 0, 0,
+                             fixture->output_a, NULL);
+
+  ops = plan (fixture, crtcs, G_N_ELEMENTS (crtcs));
+  g_assert_cmpuint (ops->len, ==, 1);
+
+  g_assert_cmpint (get_op (ops, 0)->type, ==, GF_XRANDR_OP_SET_CRTC_CONFIG);
+  g_assert_true (get_op (ops, 0)->crtc == fixture->crtc_a);
+  g_assert_true (get_op (ops, 0)->crtc_assignment == crtcs[0]);
+
+  g_array_unref (ops);
+
+  assignment_free (crtcs[0]);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/xrandr-plan/unchanged", Fixture, NULL,
+              fixture_set_up, test_unchanged, fixture_tear_down);
+
+  g_test_add ("/xrandr-plan/shrink", Fixture, NULL,
+              fixture_set_up, test_shrink, fixture_tear_down);
+
+  g_test_add ("/xrandr-plan/shrink-disable", Fixture, NULL,
+              fixture_set_up, test_shrink_disable, fixture_tear_down);
+
+  g_test_add ("/xrandr-plan/unclone", Fixture, NULL,
+              fixture_set_up, test_unclone, fixture_tear_down);
+
+  return g_test_run ();
+}